@@ -0,0 +1,151 @@
+// Batched and parallel paths: segments, circle stamps, tiled triangles, the
+// streaming chart and incremental instance redraws. Each uses a pool sized to
+// the machine.
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "../common/batch_raster.h"
+#include "../common/circle_stamp.h"
+#include "../common/damage.h"
+#include "../common/framebuffer.h"
+#include "../common/instancing.h"
+#include "../common/stream_chart.h"
+#include "../common/thread_pool.h"
+#include "../common/tile_raster.h"
+#include "bench_sinks.h"
+
+namespace {
+
+ThreadPool &pool() {
+  static ThreadPool instance;
+  return instance;
+}
+
+void BM_RasterizeSegments(benchmark::State &state) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> coordinate(-1000, 1000);
+  std::vector<Segment> segments(size_t(state.range(0)));
+  for (Segment &s : segments) {
+    s = {coordinate(rng), coordinate(rng), coordinate(rng), coordinate(rng),
+         Color(0, 0, 0)};
+  }
+  Framebuffer framebuffer(2048, 2048);
+  for (auto _ : state) {
+    rasterizeSegments(framebuffer, segments, pool());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RasterizeSegments)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->UseRealTime();
+
+void BM_StampCircles(benchmark::State &state) {
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int> x(-950, 950), y(-530, 530);
+  std::vector<CircleCenter> centers(1000000);
+  for (CircleCenter &c : centers) {
+    c = {x(rng), y(rng), Color(0, 0, 255)};
+  }
+  const CircleStamp &stamp = circleStamp(int(state.range(0)), state.range(1));
+  Framebuffer framebuffer(1920, 1080);
+  for (auto _ : state) {
+    stampCircles(framebuffer, stamp, centers, pool());
+  }
+  state.SetItemsProcessed(state.iterations() * int64_t(centers.size()));
+  state.counters["pixels/s"] = benchmark::Counter(
+      double(stamp.pixelCount() * centers.size() * state.iterations()),
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_StampCircles)
+    ->ArgsProduct({{3, 10}, {0, 1}})
+    ->ArgNames({"radius", "filled"})
+    ->UseRealTime();
+
+void BM_RasterizeTriangles(benchmark::State &state) {
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> center(-1800, 1800), offset(-50, 50);
+  std::vector<Triangle> triangles(size_t(state.range(0)));
+  for (Triangle &t : triangles) {
+    float cx = center(rng), cy = center(rng) * 0.55f;
+    t = {cx + offset(rng), cy + offset(rng), cx + offset(rng),
+         cy + offset(rng), cx + offset(rng), cy + offset(rng),
+         Color(0, 128, 0)};
+  }
+  Framebuffer framebuffer(3840, 2160);
+  for (auto _ : state) {
+    rasterizeTriangles(framebuffer, triangles, pool());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RasterizeTriangles)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->UseRealTime();
+
+void BM_StreamingChartPush(benchmark::State &state) {
+  std::vector<int> samples(size_t(state.range(0)));
+  std::mt19937 rng(4);
+  for (int &v : samples) {
+    v = int(rng() % 1000) - 500;
+  }
+  for (auto _ : state) {
+    StreamingChart chart(-900.0, 1800.0 / double(samples.size()), 4096);
+    chart.push(samples.data(), samples.size());
+    chart.flush();
+    CountingSink sink;
+    chart.drawAll(sink);
+    benchmark::DoNotOptimize(sink.checksum());
+  }
+  state.counters["points/s"] =
+      benchmark::Counter(double(state.range(0) * state.iterations()),
+                         benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_StreamingChartPush)->RangeMultiplier(10)->Range(1000, 10000000);
+
+// The lab 4 windmill, advanced one degree per frame on a canvas of
+// range(0) x range(0) * 9 / 16 pixels.
+void windmill(InstanceBatch &blades, float angle) {
+  blades.mesh = {{0, 0}, {20, 100}, {-20, 100}};
+  blades.clear();
+  for (float blade : {0.0f, 180.0f, -90.0f, 90.0f}) {
+    blades.add(Transform2D::rotation(angle + blade), Color(255, 0, 0));
+  }
+}
+
+void BM_WindmillFullRedraw(benchmark::State &state) {
+  Framebuffer framebuffer(int(state.range(0)), int(state.range(0) * 9 / 16));
+  InstanceBatch blades;
+  float angle = 0;
+  for (auto _ : state) {
+    windmill(blades, angle++);
+    framebuffer.clear(Color(255, 255, 255));
+    rasterizeInstances(framebuffer, blades, pool());
+  }
+}
+BENCHMARK(BM_WindmillFullRedraw)
+    ->Arg(1920)
+    ->Arg(3840)
+    ->Arg(7680)
+    ->UseRealTime();
+
+void BM_WindmillDamage(benchmark::State &state) {
+  Framebuffer framebuffer(int(state.range(0)), int(state.range(0) * 9 / 16));
+  DamageTracker damage(framebuffer.bounds());
+  InstanceBatch blades;
+  float angle = 0;
+  size_t rects = 0;
+  for (auto _ : state) {
+    windmill(blades, angle++);
+    rects += redrawInstances(framebuffer, blades, damage, Color(255, 255, 255),
+                             pool())
+                 .size();
+  }
+  state.counters["rects"] = double(rects) / double(state.iterations());
+}
+BENCHMARK(BM_WindmillDamage)->Arg(1920)->Arg(3840)->Arg(7680)->UseRealTime();
+
+} // namespace
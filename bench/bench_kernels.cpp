@@ -0,0 +1,142 @@
+// The specialized kernels from raster_kernels.h against the functions they
+// mirror. Each pair draws the same pixels: the PixelSink versions go through
+// the Framebuffer's virtual plot(), the kernels write the pixels through a
+// SurfaceSink, in each pixel format. The CountingSink pairs compare the
+// algorithms without memory traffic.
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "../common/framebuffer.h"
+#include "../common/raster.h"
+#include "../common/raster_kernels.h"
+#include "bench_sinks.h"
+
+namespace {
+
+const int kSize = 2048;
+
+void reportPixels(benchmark::State &state, uint64_t pixels) {
+  state.counters["pixels/s"] =
+      benchmark::Counter(double(pixels), benchmark::Counter::kIsRate);
+}
+
+// Lines of range(0) pixels from the origin through the middle of each
+// octant; fn(x, y) draws one and returns its pixel count.
+template <typename Draw> void eachOctant(benchmark::State &state, Draw fn) {
+  int length = int(state.range(0));
+  uint64_t pixels = 0;
+  for (auto _ : state) {
+    for (int octant = 0; octant < 8; ++octant) {
+      double angle = (octant * 45 + 22.5) * M_PI / 180;
+      int x = int(std::lround(length * std::cos(angle)));
+      int y = int(std::lround(length * std::sin(angle)));
+      fn(x, y);
+      pixels += uint64_t(std::max(std::abs(x), std::abs(y)) + 1);
+    }
+  }
+  reportPixels(state, pixels);
+}
+
+// A surface of the format's pixels the size of the benchmark framebuffer.
+template <typename Format> struct Surface {
+  std::vector<typename Format::Pixel> pixels =
+      std::vector<typename Format::Pixel>(size_t(kSize) * kSize);
+  SurfaceSink<Format> sink{pixels.data(), kSize, kSize, kSize};
+};
+
+void BM_LineVirtual(benchmark::State &state) {
+  Framebuffer framebuffer(kSize, kSize);
+  framebuffer.setColor(Color(0, 0, 0));
+  eachOctant(state, [&](int x, int y) { bresenham(framebuffer, 0, 0, x, y); });
+}
+BENCHMARK(BM_LineVirtual)->Arg(1000);
+
+template <typename Format> void BM_LineKernel(benchmark::State &state) {
+  Surface<Format> surface;
+  surface.sink.setPixel(1);
+  eachOctant(state,
+             [&](int x, int y) { bresenhamKernel(surface.sink, 0, 0, x, y); });
+}
+BENCHMARK_TEMPLATE(BM_LineKernel, RGBA8)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_LineKernel, A8)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_LineKernel, Index8)->Arg(1000);
+
+void BM_LineCounting(benchmark::State &state) {
+  CountingSink sink;
+  eachOctant(state, [&](int x, int y) { bresenham(sink, 0, 0, x, y); });
+  benchmark::DoNotOptimize(sink.checksum());
+}
+BENCHMARK(BM_LineCounting)->Arg(1000);
+
+void BM_LineKernelCounting(benchmark::State &state) {
+  CountingSink counter;
+  PlotSink<CountingSink> sink(counter);
+  eachOctant(state, [&](int x, int y) { bresenhamKernel(sink, 0, 0, x, y); });
+  benchmark::DoNotOptimize(counter.checksum());
+}
+BENCHMARK(BM_LineKernelCounting)->Arg(1000);
+
+// Circles and 2:1 ellipses of radius range(0) in the middle of the surface.
+// Pixel counts come from a CountingSink, once.
+void BM_CircleVirtual(benchmark::State &state) {
+  Framebuffer framebuffer(kSize, kSize);
+  framebuffer.setColor(Color(0, 0, 0));
+  int r = int(state.range(0));
+  CountingSink counter;
+  midPointCircle(counter, 0, 0, r);
+  for (auto _ : state) {
+    midPointCircle(framebuffer, 0, 0, r);
+  }
+  reportPixels(state, counter.pixels() * state.iterations());
+}
+BENCHMARK(BM_CircleVirtual)->RangeMultiplier(10)->Range(10, 1000);
+
+template <typename Format> void BM_CircleKernel(benchmark::State &state) {
+  Surface<Format> surface;
+  surface.sink.setPixel(1);
+  int r = int(state.range(0));
+  CountingSink counter;
+  midPointCircle(counter, 0, 0, r);
+  for (auto _ : state) {
+    midPointCircleKernel(surface.sink, 0, 0, r);
+  }
+  reportPixels(state, counter.pixels() * state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_CircleKernel, RGBA8)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+BENCHMARK_TEMPLATE(BM_CircleKernel, A8)->RangeMultiplier(10)->Range(10, 1000);
+
+void BM_EllipseVirtual(benchmark::State &state) {
+  Framebuffer framebuffer(kSize, kSize);
+  framebuffer.setColor(Color(0, 0, 0));
+  int rx = int(state.range(0));
+  CountingSink counter;
+  midPointEllipse(counter, 0, 0, rx, rx / 2);
+  for (auto _ : state) {
+    midPointEllipse(framebuffer, 0, 0, rx, rx / 2);
+  }
+  reportPixels(state, counter.pixels() * state.iterations());
+}
+BENCHMARK(BM_EllipseVirtual)->RangeMultiplier(10)->Range(10, 1000);
+
+template <typename Format> void BM_EllipseKernel(benchmark::State &state) {
+  Surface<Format> surface;
+  surface.sink.setPixel(1);
+  int rx = int(state.range(0));
+  CountingSink counter;
+  midPointEllipse(counter, 0, 0, rx, rx / 2);
+  for (auto _ : state) {
+    midPointEllipseKernel(surface.sink, 0, 0, rx, rx / 2);
+  }
+  reportPixels(state, counter.pixels() * state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_EllipseKernel, RGBA8)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000);
+BENCHMARK_TEMPLATE(BM_EllipseKernel, A8)->RangeMultiplier(10)->Range(10, 1000);
+
+} // namespace
@@ -0,0 +1,182 @@
+// Single primitives from raster.h and antialias.h. Every benchmark reports
+// pixels/s; the CountingSink variants measure the algorithm alone and the
+// Framebuffer variants include the memory writes.
+//
+// The suite links against benchmark_main; for results that can be compared
+// between commits run it with
+//   --benchmark_format=json --benchmark_out=results.json
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include "../common/antialias.h"
+#include "../common/framebuffer.h"
+#include "../common/raster.h"
+#include "bench_sinks.h"
+
+namespace {
+
+void reportPixels(benchmark::State &state, uint64_t pixels) {
+  state.counters["pixels/s"] =
+      benchmark::Counter(double(pixels), benchmark::Counter::kIsRate);
+  state.counters["pixels"] = double(pixels) / double(state.iterations());
+}
+
+// End point of a line of the given length through the middle of octant
+// range(0), starting at the origin.
+void lineEnd(const benchmark::State &state, int &x, int &y) {
+  double angle = (state.range(0) * 45 + 22.5) * M_PI / 180;
+  x = int(std::lround(state.range(1) * std::cos(angle)));
+  y = int(std::lround(state.range(1) * std::sin(angle)));
+}
+
+void lineArgs(benchmark::internal::Benchmark *b) {
+  for (int length : {8, 1000}) {
+    for (int octant = 0; octant < 8; ++octant) {
+      b->Args({octant, length});
+    }
+  }
+  b->ArgNames({"octant", "length"});
+}
+
+template <void (*Line)(PixelSink &, int, int, int, int)>
+void BM_Line(benchmark::State &state) {
+  int x, y;
+  lineEnd(state, x, y);
+  CountingSink sink;
+  for (auto _ : state) {
+    Line(sink, 0, 0, x, y);
+  }
+  benchmark::DoNotOptimize(sink.checksum());
+  reportPixels(state, sink.pixels());
+}
+BENCHMARK_TEMPLATE(BM_Line, bresenham)->Apply(lineArgs);
+BENCHMARK_TEMPLATE(BM_Line, bresenhamSpans)->Apply(lineArgs);
+BENCHMARK_TEMPLATE(BM_Line, DDA_line)->Apply(lineArgs);
+BENCHMARK_TEMPLATE(BM_Line, DDA_lineSpans)->Apply(lineArgs);
+
+void BM_WuLine(benchmark::State &state) {
+  int x, y;
+  lineEnd(state, x, y);
+  CountingSink sink;
+  for (auto _ : state) {
+    wuLine(sink, 0.0f, 0.0f, float(x), float(y));
+  }
+  benchmark::DoNotOptimize(sink.checksum());
+  reportPixels(state, sink.pixels());
+}
+BENCHMARK(BM_WuLine)->Apply(lineArgs);
+
+void BM_LineDDAFloat(benchmark::State &state) {
+  int x, y;
+  lineEnd(state, x, y);
+  CountingSink sink;
+  for (auto _ : state) {
+    drawLineDDA(sink, 0.0f, 0.0f, float(x), float(y));
+  }
+  benchmark::DoNotOptimize(sink.checksum());
+  reportPixels(state, sink.pixels());
+}
+BENCHMARK(BM_LineDDAFloat)->Apply(lineArgs);
+
+// Long lines into a framebuffer, all octants per iteration.
+template <void (*Line)(PixelSink &, int, int, int, int)>
+void BM_LineFramebuffer(benchmark::State &state) {
+  Framebuffer framebuffer(2048, 2048);
+  framebuffer.setColor(Color(0, 0, 0));
+  int length = int(state.range(0));
+  uint64_t pixels = 0;
+  for (auto _ : state) {
+    for (int octant = 0; octant < 8; ++octant) {
+      double angle = (octant * 45 + 22.5) * M_PI / 180;
+      int x = int(std::lround(length * std::cos(angle)));
+      int y = int(std::lround(length * std::sin(angle)));
+      Line(framebuffer, 0, 0, x, y);
+      pixels += uint64_t(std::max(std::abs(x), std::abs(y)) + 1);
+    }
+  }
+  reportPixels(state, pixels);
+}
+BENCHMARK_TEMPLATE(BM_LineFramebuffer, bresenham)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_LineFramebuffer, bresenhamSpans)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_LineFramebuffer, DDA_line)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_LineFramebuffer, DDA_lineSpans)->Arg(1000);
+
+template <void (*Circle)(PixelSink &, int, int, int)>
+void BM_Circle(benchmark::State &state) {
+  CountingSink sink;
+  for (auto _ : state) {
+    Circle(sink, 0, 0, int(state.range(0)));
+  }
+  benchmark::DoNotOptimize(sink.checksum());
+  reportPixels(state, sink.pixels());
+}
+BENCHMARK_TEMPLATE(BM_Circle, midPointCircle)
+    ->RangeMultiplier(10)
+    ->Range(1, 10000);
+BENCHMARK_TEMPLATE(BM_Circle, polarCoordinateCircle)
+    ->RangeMultiplier(10)
+    ->Range(1, 10000);
+BENCHMARK_TEMPLATE(BM_Circle, fillCircle)->RangeMultiplier(10)->Range(1, 10000);
+
+// Ellipses with a 2:1 aspect ratio, rx = range(0).
+template <void (*Ellipse)(PixelSink &, int, int, int, int)>
+void BM_Ellipse(benchmark::State &state) {
+  CountingSink sink;
+  int rx = int(state.range(0));
+  for (auto _ : state) {
+    Ellipse(sink, 0, 0, rx, std::max(rx / 2, 1));
+  }
+  benchmark::DoNotOptimize(sink.checksum());
+  reportPixels(state, sink.pixels());
+}
+BENCHMARK_TEMPLATE(BM_Ellipse, midPointEllipse)
+    ->RangeMultiplier(10)
+    ->Range(1, 10000);
+BENCHMARK_TEMPLATE(BM_Ellipse, fillEllipse)
+    ->RangeMultiplier(10)
+    ->Range(1, 10000);
+
+template <void (*Fill)(PixelSink &, int, int, int)>
+void BM_FillCircleFramebuffer(benchmark::State &state) {
+  Framebuffer framebuffer(2048, 2048);
+  framebuffer.setColor(Color(0, 0, 0));
+  CountingSink counter;
+  Fill(counter, 0, 0, int(state.range(0)));
+  for (auto _ : state) {
+    Fill(framebuffer, 0, 0, int(state.range(0)));
+  }
+  reportPixels(state, counter.pixels() * state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_FillCircleFramebuffer, fillCircle)
+    ->RangeMultiplier(10)
+    ->Range(1, 1000);
+
+void BM_FillTriangle(benchmark::State &state) {
+  Framebuffer framebuffer(2048, 2048);
+  framebuffer.setColor(Color(0, 0, 0));
+  float size = float(state.range(0));
+  CountingSink counter;
+  fillTriangle(counter, -size, -size, size, -size * 0.5f, 0.0f, size);
+  for (auto _ : state) {
+    fillTriangle(framebuffer, -size, -size, size, -size * 0.5f, 0.0f, size);
+  }
+  reportPixels(state, counter.pixels() * state.iterations());
+}
+BENCHMARK(BM_FillTriangle)->RangeMultiplier(10)->Range(1, 1000);
+
+void BM_StrokeArc(benchmark::State &state) {
+  Framebuffer framebuffer(2048, 2048);
+  framebuffer.setColor(Color(255, 0, 0));
+  CountingSink counter;
+  float radius = float(state.range(0));
+  strokeArc(counter, 0.0f, 0.0f, radius, 0.5f, 3.0f, 8.0f);
+  for (auto _ : state) {
+    strokeArc(framebuffer, 0.0f, 0.0f, radius, 0.5f, 3.0f, 8.0f);
+  }
+  reportPixels(state, counter.pixels() * state.iterations());
+}
+BENCHMARK(BM_StrokeArc)->RangeMultiplier(10)->Range(10, 1000);
+
+} // namespace
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../common/pixel_sink.h"
+
+// Sink that only counts what it is given, so a benchmark measures the
+// rasterizer itself at any size without memory traffic.
+class CountingSink final : public PixelSink {
+public:
+  void setColor(Color) override {}
+  void plot(int x, int y) override {
+    pixels_++;
+    checksum_ += uint32_t(x) ^ uint32_t(y);
+  }
+  void span(int x0, int x1, int y) override {
+    pixels_ += uint64_t(x1 - x0 + 1);
+    checksum_ += uint32_t(x0) ^ uint32_t(y);
+  }
+  void vspan(int x, int y0, int y1) override {
+    pixels_ += uint64_t(y1 - y0 + 1);
+    checksum_ += uint32_t(x) ^ uint32_t(y0);
+  }
+  void blend(int x, int y, uint8_t coverage) override {
+    pixels_++;
+    checksum_ += uint32_t(x) ^ uint32_t(y) ^ coverage;
+  }
+
+  uint64_t pixels() const { return pixels_; }
+  uint32_t checksum() const { return checksum_; }
+
+private:
+  uint64_t pixels_ = 0;
+  uint32_t checksum_ = 0;
+};
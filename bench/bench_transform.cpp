@@ -0,0 +1,104 @@
+// Point transforms (the lab4 Transformation path) and transform composition.
+// Reported as points/s.
+
+#include <benchmark/benchmark.h>
+
+#include "../common/instancing.h"
+#include "../common/transform.h"
+
+namespace {
+
+void reportPoints(benchmark::State &state, uint64_t points) {
+  state.counters["points/s"] =
+      benchmark::Counter(double(points), benchmark::Counter::kIsRate);
+}
+
+PointBuffer makePoints(size_t count) {
+  PointBuffer points;
+  points.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    points.x()[i] = float(i % 1000) - 500.0f;
+    points.y()[i] = float(i / 1000 % 1000) - 500.0f;
+  }
+  return points;
+}
+
+const Transform2D kTransform = Transform2D::translation(10.0f, -5.0f) *
+                               Transform2D::rotation(30.0f) *
+                               Transform2D::scaling(1.5f, 0.75f);
+
+void BM_ApplyTransformInPlace(benchmark::State &state) {
+  PointBuffer points = makePoints(size_t(state.range(0)));
+  for (auto _ : state) {
+    applyTransform(kTransform, points);
+    benchmark::DoNotOptimize(points.x());
+    benchmark::ClobberMemory();
+  }
+  reportPoints(state, uint64_t(state.range(0)) * state.iterations());
+}
+BENCHMARK(BM_ApplyTransformInPlace)->RangeMultiplier(10)->Range(1, 10000000);
+
+void BM_ApplyTransformCopy(benchmark::State &state) {
+  PointBuffer points = makePoints(size_t(state.range(0)));
+  PointBuffer out;
+  for (auto _ : state) {
+    applyTransform(kTransform, points, out);
+    benchmark::DoNotOptimize(out.x());
+    benchmark::ClobberMemory();
+  }
+  reportPoints(state, uint64_t(state.range(0)) * state.iterations());
+}
+BENCHMARK(BM_ApplyTransformCopy)->RangeMultiplier(10)->Range(1, 10000000);
+
+// Scalar reference: one Transform2D::apply per point.
+void BM_ApplyTransformScalar(benchmark::State &state) {
+  PointBuffer points = makePoints(size_t(state.range(0)));
+  for (auto _ : state) {
+    for (size_t i = 0; i < points.size(); ++i) {
+      auto p = kTransform.apply(points.x()[i], points.y()[i]);
+      points.x()[i] = p[0];
+      points.y()[i] = p[1];
+    }
+    benchmark::DoNotOptimize(points.x());
+    benchmark::ClobberMemory();
+  }
+  reportPoints(state, uint64_t(state.range(0)) * state.iterations());
+}
+BENCHMARK(BM_ApplyTransformScalar)->RangeMultiplier(10)->Range(1, 10000000);
+
+// Building a windmill-style hierarchy: rotate, then push/rotate/pop per
+// child.
+void BM_TransformStack(benchmark::State &state) {
+  TransformStack stack;
+  float angle = 0.0f;
+  for (auto _ : state) {
+    stack.loadIdentity();
+    stack.rotate(angle);
+    for (int i = 0; i < 4; ++i) {
+      stack.push();
+      stack.rotate(90.0f * i);
+      benchmark::DoNotOptimize(stack.top());
+      stack.pop();
+    }
+    angle += 1.0f;
+  }
+  state.SetItemsProcessed(state.iterations() * 4);
+}
+BENCHMARK(BM_TransformStack);
+
+void BM_ExpandInstances(benchmark::State &state) {
+  InstanceBatch batch;
+  batch.mesh = PointBuffer{{0.0f, 0.0f}, {20.0f, 100.0f}, {-20.0f, 100.0f}};
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    batch.add(Transform2D::rotation(float(i % 360)), Color(255, 0, 0));
+  }
+  InstanceVertices out;
+  for (auto _ : state) {
+    expandInstances(batch, out);
+    benchmark::DoNotOptimize(out.xy.data());
+  }
+  reportPoints(state, uint64_t(state.range(0)) * 3 * state.iterations());
+}
+BENCHMARK(BM_ExpandInstances)->RangeMultiplier(10)->Range(1, 1000000);
+
+} // namespace
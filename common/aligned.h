@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Allocator that hands out storage aligned to Alignment bytes (a cache line by
+// default) so pixel rows and coordinate arrays can be streamed with SIMD.
+template <typename T, std::size_t Alignment = 64> struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    std::size_t bytes = n * sizeof(T);
+    bytes = (bytes + Alignment - 1) / Alignment * Alignment;
+    void *p = std::aligned_alloc(Alignment, bytes == 0 ? Alignment : bytes);
+    if (!p) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(p);
+  }
+
+  void deallocate(T *p, std::size_t) noexcept { std::free(p); }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+    return false;
+  }
+};
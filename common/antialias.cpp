@@ -0,0 +1,220 @@
+#include "antialias.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+const int64_t kSubpixel = 256;
+
+int64_t toFixed(float v) { return std::llround(double(v) * kSubpixel); }
+
+int64_t floorDiv(int64_t a, int64_t b) {
+  int64_t q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Narrow [lo, hi] towards the x where v0 + k * x lies strictly between
+// minV and maxV. The bounds may stay one pixel loose; callers evaluate the
+// exact coverage anyway.
+void narrow(int64_t v0, int64_t k, int64_t minV, int64_t maxV, int64_t &lo,
+            int64_t &hi) {
+  if (k == 0) {
+    if (v0 <= minV || v0 >= maxV) {
+      hi = lo - 1;
+    }
+    return;
+  }
+  int64_t a = floorDiv(minV - v0, k), b = floorDiv(maxV - v0, k);
+  lo = std::max(lo, std::min(a, b));
+  hi = std::min(hi, std::max(a, b) + 1);
+}
+
+// Coverage of a pixel whose center is inside by the given distance, in
+// 1/256 pixel: a one pixel ramp centered on the edge, 0-256.
+int64_t edgeCoverage(int64_t inside) {
+  return std::min<int64_t>(std::max<int64_t>(inside + kSubpixel / 2, 0),
+                           kSubpixel);
+}
+
+uint8_t toCoverage(int64_t a, int64_t b) {
+  return uint8_t(a * b * 255 / (kSubpixel * kSubpixel));
+}
+
+} // namespace
+
+void wuLine(PixelSink &sink, float x0, float y0, float x1, float y1) {
+  int64_t ax = toFixed(x0), ay = toFixed(y0), bx = toFixed(x1),
+          by = toFixed(y1);
+  bool steep = std::abs(by - ay) > std::abs(bx - ax);
+  if (steep) {
+    std::swap(ax, ay);
+    std::swap(bx, by);
+  }
+  if (ax > bx) {
+    std::swap(ax, bx);
+    std::swap(ay, by);
+  }
+  auto put = [&](int64_t major, int64_t minor, int64_t coverage) {
+    if (coverage > 0) {
+      if (steep) {
+        sink.blend(int(minor), int(major), uint8_t(coverage));
+      } else {
+        sink.blend(int(major), int(minor), uint8_t(coverage));
+      }
+    }
+  };
+
+  int64_t dx = bx - ax, dy = by - ay;
+  if (dx == 0) {
+    put((ax + kSubpixel / 2) >> 8, (ay + kSubpixel / 2) >> 8, 255);
+    return;
+  }
+  // Minor coordinate per major pixel and positions along the minor axis in
+  // 16.16 fixed point.
+  const int64_t gradient = (dy << 16) / dx;
+  auto minorAt = [&](int64_t major) {
+    return (ay << 8) + ((gradient * (major * kSubpixel - ax)) >> 8);
+  };
+  // Both pixels straddling the line at one major position; weight is the
+  // fraction of that pixel the line spans along the major axis, in 1/256.
+  auto putPair = [&](int64_t major, int64_t minor, int64_t weight) {
+    int64_t fraction = minor & 0xffff;
+    put(major, minor >> 16, ((0x10000 - fraction) * weight * 255) >> 24);
+    put(major, (minor >> 16) + 1, (fraction * weight * 255) >> 24);
+  };
+
+  int64_t first = (ax + kSubpixel / 2) >> 8;
+  int64_t last = (bx + kSubpixel / 2) >> 8;
+  if (first == last) {
+    putPair(first, minorAt(first), std::min(dx, kSubpixel));
+    return;
+  }
+  putPair(first, minorAt(first), kSubpixel - ((ax + kSubpixel / 2) & 255));
+  putPair(last, minorAt(last), (bx + kSubpixel / 2) & 255);
+
+  int64_t minor = minorAt(first + 1);
+  for (int64_t major = first + 1; major < last; ++major) {
+    int64_t fraction = minor & 0xffff;
+    put(major, minor >> 16, 255 - (fraction >> 8));
+    put(major, (minor >> 16) + 1, fraction >> 8);
+    minor += gradient;
+  }
+}
+
+void strokeLine(PixelSink &sink, float x0, float y0, float x1, float y1,
+                float width) {
+  int64_t ax = toFixed(x0), ay = toFixed(y0), bx = toFixed(x1),
+          by = toFixed(y1);
+  int64_t half = toFixed(width) / 2;
+  int64_t dx = bx - ax, dy = by - ay;
+  if (half <= 0 || (dx == 0 && dy == 0)) {
+    return;
+  }
+  // Unit tangent and normal in 16.16. Distances below are in 1/256 pixel
+  // scaled by 2^16.
+  double length = std::sqrt(double(dx * dx + dy * dy));
+  int64_t tx = std::llround(dx * 65536.0 / length);
+  int64_t ty = std::llround(dy * 65536.0 / length);
+  int64_t end = std::llround(length) << 16;
+  int64_t limit = (half + kSubpixel / 2) << 16, ramp = kSubpixel << 15;
+
+  int64_t margin = half + kSubpixel;
+  int64_t firstRow = floorDiv(std::min(ay, by) - margin, kSubpixel);
+  int64_t lastRow = floorDiv(std::max(ay, by) + margin, kSubpixel);
+  int64_t firstCol = floorDiv(std::min(ax, bx) - margin, kSubpixel);
+  int64_t lastCol = floorDiv(std::max(ax, bx) + margin, kSubpixel);
+
+  for (int64_t row = firstRow; row <= lastRow; ++row) {
+    int64_t py = row * kSubpixel + kSubpixel / 2 - ay;
+    // Signed distance across and position along the segment at column 0;
+    // each column adds one pixel's worth.
+    int64_t px0 = kSubpixel / 2 - ax;
+    int64_t across = px0 * -ty + py * tx, along = px0 * tx + py * ty;
+    int64_t stepAcross = -ty * kSubpixel, stepAlong = tx * kSubpixel;
+    int64_t lo = firstCol, hi = lastCol;
+    narrow(across, stepAcross, -limit, limit, lo, hi);
+    narrow(along, stepAlong, -ramp, end + ramp, lo, hi);
+    for (int64_t col = lo; col <= hi; ++col) {
+      int64_t a = across + col * stepAcross, t = along + col * stepAlong;
+      int64_t cross = edgeCoverage((half - std::abs(a) / 65536));
+      int64_t run = edgeCoverage(std::min(t, end - t) / 65536);
+      uint8_t coverage = toCoverage(cross, run);
+      if (coverage > 0) {
+        sink.blend(int(col), int(row), coverage);
+      }
+    }
+  }
+}
+
+void strokeArc(PixelSink &sink, float x_center, float y_center, float radius,
+               float startAngle, float endAngle, float width) {
+  int64_t cx = toFixed(x_center), cy = toFixed(y_center);
+  int64_t r = toFixed(radius), half = toFixed(width) / 2;
+  if (half <= 0 || r < 0) {
+    return;
+  }
+  double sweep = double(endAngle) - double(startAngle);
+  if (sweep < 0) {
+    std::swap(startAngle, endAngle);
+    sweep = -sweep;
+  }
+  bool fullCircle = sweep >= 2.0 * M_PI;
+  // End directions quantized to 16.16 so the wedge test is integer.
+  int64_t c0 = std::llround(std::cos(double(startAngle)) * 65536.0);
+  int64_t s0 = std::llround(std::sin(double(startAngle)) * 65536.0);
+  int64_t c1 = std::llround(std::cos(double(endAngle)) * 65536.0);
+  int64_t s1 = std::llround(std::sin(double(endAngle)) * 65536.0);
+
+  int64_t outer = r + half + kSubpixel, inner = r - half - kSubpixel;
+  int64_t firstRow = floorDiv(cy - outer, kSubpixel);
+  int64_t lastRow = floorDiv(cy + outer, kSubpixel);
+
+  auto pixel = [&](int64_t col, int64_t row, int64_t py) {
+    int64_t px = col * kSubpixel + kSubpixel / 2 - cx;
+    int64_t distance = int64_t(std::sqrt(double(px * px + py * py)));
+    int64_t radial = edgeCoverage(half - std::abs(distance - r));
+    if (radial == 0) {
+      return;
+    }
+    int64_t angular = kSubpixel;
+    if (!fullCircle) {
+      // Signed distances to the start and end radii, positive inside.
+      int64_t fromStart = edgeCoverage((c0 * py - s0 * px) / 65536);
+      int64_t fromEnd = edgeCoverage((s1 * px - c1 * py) / 65536);
+      angular = sweep <= M_PI ? fromStart * fromEnd / kSubpixel
+                              : std::max(fromStart, fromEnd);
+    }
+    uint8_t coverage = toCoverage(radial, angular);
+    if (coverage > 0) {
+      sink.blend(int(col), int(row), coverage);
+    }
+  };
+
+  for (int64_t row = firstRow; row <= lastRow; ++row) {
+    int64_t py = row * kSubpixel + kSubpixel / 2 - cy;
+    // Columns between the inner and outer circles, one pixel loose.
+    double outerHalf =
+        std::sqrt(std::max(double(outer * outer - py * py), 0.0));
+    int64_t outerLo = floorDiv(cx - int64_t(outerHalf), kSubpixel) - 1;
+    int64_t outerHi = floorDiv(cx + int64_t(outerHalf), kSubpixel) + 1;
+    if (inner > 0 && std::abs(py) < inner) {
+      double innerHalf = std::sqrt(double(inner * inner - py * py));
+      int64_t innerLo = floorDiv(cx - int64_t(innerHalf), kSubpixel) + 1;
+      int64_t innerHi = floorDiv(cx + int64_t(innerHalf), kSubpixel) - 1;
+      for (int64_t col = outerLo; col < innerLo; ++col) {
+        pixel(col, row, py);
+      }
+      for (int64_t col = std::max(innerHi + 1, innerLo); col <= outerHi;
+           ++col) {
+        pixel(col, row, py);
+      }
+    } else {
+      for (int64_t col = outerLo; col <= outerHi; ++col) {
+        pixel(col, row, py);
+      }
+    }
+  }
+}
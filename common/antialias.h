@@ -0,0 +1,31 @@
+#pragma once
+
+#include "pixel_sink.h"
+
+// Anti-aliased rasterizers. They write partially covered pixels through
+// PixelSink::blend(), so a Framebuffer blends the current color by coverage
+// while the GL point sink falls back to thresholding. All coverage is
+// computed from coordinates snapped to 1/256 pixel with integer arithmetic
+// (plus correctly rounded square roots), so wuLine() and strokeLine() are
+// bit-identical on every machine. strokeArc() takes its end directions from
+// std::cos and std::sin, which can differ in the last bit between C
+// libraries, so pixels along its butt ends may differ there.
+
+// Xiaolin Wu line in the same pixel-index space as bresenham(): integer
+// coordinates are pixel centers. Two pixels per column (or row, for steep
+// lines) share the coverage; the end pixels are weighted by how far the line
+// extends into them.
+void wuLine(PixelSink &sink, float x0, float y0, float x1, float y1);
+
+// The following take continuous coordinates like the GL path and
+// fillTriangle(): pixel (x, y) covers [x, x + 1) x [y, y + 1). Coverage is
+// the pixel center's distance to the shape's edge, ramped over one pixel.
+
+// Stroke of the given width along a segment, with butt ends.
+void strokeLine(PixelSink &sink, float x0, float y0, float x1, float y1,
+                float width);
+
+// Stroke of the given width centered on a circular arc from startAngle to
+// endAngle (radians, counter-clockwise), with butt ends along the radii.
+void strokeArc(PixelSink &sink, float x_center, float y_center, float radius,
+               float startAngle, float endAngle, float width);
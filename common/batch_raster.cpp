@@ -0,0 +1,58 @@
+#include "batch_raster.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "profiler.h"
+#include "raster.h"
+
+void rasterizeSegments(Framebuffer &framebuffer, const Segment *segments,
+                       size_t count, ThreadPool &pool, int bandHeight) {
+  CG_PROFILE_SCOPE("rasterizeSegments");
+  if (count == 0 || framebuffer.height() == 0) {
+    return;
+  }
+  bandHeight = std::max(bandHeight, 1);
+  int bands = (framebuffer.height() + bandHeight - 1) / bandHeight;
+
+  // Bin segment indices per band. Chunks of the input are binned in parallel
+  // and kept separate so each band still sees its segments in input order.
+  const size_t chunkSize = 4096;
+  size_t chunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<std::vector<std::vector<uint32_t>>> bins(
+      chunks, std::vector<std::vector<uint32_t>>(bands));
+  pool.parallelFor(chunks, [&](size_t c) {
+    size_t end = std::min(count, (c + 1) * chunkSize);
+    for (size_t i = c * chunkSize; i < end; ++i) {
+      const Segment &s = segments[i];
+      // Higher y is a lower row.
+      int firstRow = framebuffer.toRow(std::max(s.y1, s.y2));
+      int lastRow = framebuffer.toRow(std::min(s.y1, s.y2));
+      if (lastRow < 0 || firstRow >= framebuffer.height()) {
+        continue;
+      }
+      int firstBand = std::max(firstRow, 0) / bandHeight;
+      int lastBand = std::min(lastRow, framebuffer.height() - 1) / bandHeight;
+      for (int b = firstBand; b <= lastBand; ++b) {
+        bins[c][b].push_back(uint32_t(i));
+      }
+    }
+  });
+
+  Rect bounds = framebuffer.bounds();
+  pool.parallelFor(size_t(bands), [&](size_t b) {
+    CG_PROFILE_SCOPE("rasterizeSegments band");
+    int firstRow = int(b) * bandHeight;
+    int lastRow = std::min(firstRow + bandHeight, framebuffer.height()) - 1;
+    Rect band = {bounds.xmin, bounds.ymax - lastRow, bounds.xmax,
+                 bounds.ymax - firstRow};
+    FramebufferRegion region(framebuffer, band);
+    for (size_t c = 0; c < chunks; ++c) {
+      for (uint32_t i : bins[c][b]) {
+        const Segment &s = segments[i];
+        region.setColor(s.color);
+        bresenhamSpans(region, region.clip(), s.x1, s.y1, s.x2, s.y2);
+      }
+    }
+  });
+}
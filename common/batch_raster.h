@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "framebuffer.h"
+#include "thread_pool.h"
+
+struct Segment {
+  int x1, y1, x2, y2;
+  Color color;
+};
+
+// Rasterize many Bresenham segments into a framebuffer on a thread pool.
+//
+// The framebuffer is split into horizontal bands of bandHeight rows and every
+// band is owned by exactly one task, which draws the segments that touch it
+// clipped to its rows, stepping only through the part inside them. Within a
+// band segments are drawn in input order, so the result is identical to
+// drawing them one after another with bresenhamSpans().
+void rasterizeSegments(Framebuffer &framebuffer, const Segment *segments,
+                       size_t count, ThreadPool &pool, int bandHeight = 32);
+
+inline void rasterizeSegments(Framebuffer &framebuffer,
+                              const std::vector<Segment> &segments,
+                              ThreadPool &pool, int bandHeight = 32) {
+  rasterizeSegments(framebuffer, segments.data(), segments.size(), pool,
+                    bandHeight);
+}
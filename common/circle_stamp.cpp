@@ -0,0 +1,173 @@
+#include "circle_stamp.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "profiler.h"
+
+#include "raster.h"
+
+namespace {
+
+// Collects what the midpoint rasterizers emit as per-row column ranges.
+class RowCollector : public PixelSink {
+public:
+  void setColor(Color) override {}
+  void plot(int x, int y) override { span(x, x, y); }
+  void span(int x0, int x1, int y) override {
+    std::vector<int> &columns = rows[y];
+    for (int x = x0; x <= x1; ++x) {
+      columns.push_back(x);
+    }
+  }
+
+  std::map<int, std::vector<int>> rows;
+};
+
+} // namespace
+
+CircleStamp::CircleStamp(int radius, bool filled)
+    : radius_(radius), filled_(filled) {
+  RowCollector collector;
+  if (filled) {
+    fillCircle(collector, 0, 0, radius);
+  } else {
+    midPointCircle(collector, 0, 0, radius);
+  }
+
+  // Deduplicate each row and split it into contiguous runs, top row first.
+  for (auto it = collector.rows.rbegin(); it != collector.rows.rend(); ++it) {
+    std::vector<int> &columns = it->second;
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+    for (size_t i = 0; i < columns.size();) {
+      size_t j = i + 1;
+      while (j < columns.size() && columns[j] == columns[j - 1] + 1) {
+        ++j;
+      }
+      runs_.push_back({it->first, columns[i], columns[j - 1]});
+      pixelCount_ += j - i;
+      i = j;
+    }
+  }
+}
+
+void CircleStamp::draw(PixelSink &sink, int x_center, int y_center) const {
+  for (const Run &run : runs_) {
+    sink.span(x_center + run.dx0, x_center + run.dx1, y_center + run.dy);
+  }
+}
+
+const CircleStamp &circleStamp(int radius, bool filled) {
+  static std::mutex mutex;
+  static std::unordered_map<int64_t, std::unique_ptr<CircleStamp>> stamps;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &stamp = stamps[int64_t(radius) * 2 + (filled ? 1 : 0)];
+  if (!stamp) {
+    stamp = std::make_unique<CircleStamp>(radius, filled);
+  }
+  return *stamp;
+}
+
+void stampCircles(Framebuffer &framebuffer, const CircleStamp &stamp,
+                  const CircleCenter *centers, size_t count, ThreadPool &pool,
+                  int bandHeight) {
+  CG_PROFILE_SCOPE("stampCircles");
+  const std::vector<CircleStamp::Run> &runs = stamp.runs();
+  if (count == 0 || runs.empty() || framebuffer.height() == 0) {
+    return;
+  }
+  bandHeight = std::max(bandHeight, 1);
+  int bands = (framebuffer.height() + bandHeight - 1) / bandHeight;
+  int top = runs.front().dy, bottom = runs.back().dy;
+  int left = runs.front().dx0, right = runs.front().dx1;
+  for (const CircleStamp::Run &run : runs) {
+    left = std::min(left, run.dx0);
+    right = std::max(right, run.dx1);
+  }
+
+  // Offsets from the center pixel in this buffer's layout: one per pixel for
+  // short runs (the outline) and one per run for long ones (filled rows), so
+  // an unclipped stamp is a list of plain stores and span fills.
+  const int longRun = 8;
+  struct Span {
+    ptrdiff_t start;
+    size_t length;
+  };
+  std::vector<ptrdiff_t> pixelOffsets;
+  std::vector<Span> spanOffsets;
+  for (const CircleStamp::Run &run : runs) {
+    ptrdiff_t start = -ptrdiff_t(run.dy) * framebuffer.stride() + run.dx0;
+    int length = run.dx1 - run.dx0 + 1;
+    if (length < longRun) {
+      for (int k = 0; k < length; ++k) {
+        pixelOffsets.push_back(start + k);
+      }
+    } else {
+      spanOffsets.push_back({start, size_t(length)});
+    }
+  }
+
+  // Bin center indices per band; chunks are binned in parallel and kept
+  // apart to preserve input order.
+  const size_t chunkSize = 4096;
+  size_t chunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<std::vector<std::vector<uint32_t>>> bins(
+      chunks, std::vector<std::vector<uint32_t>>(bands));
+  pool.parallelFor(chunks, [&](size_t c) {
+    size_t end = std::min(count, (c + 1) * chunkSize);
+    for (size_t i = c * chunkSize; i < end; ++i) {
+      int firstRow = framebuffer.toRow(centers[i].y + top);
+      int lastRow = framebuffer.toRow(centers[i].y + bottom);
+      if (lastRow < 0 || firstRow >= framebuffer.height()) {
+        continue;
+      }
+      int firstBand = std::max(firstRow, 0) / bandHeight;
+      int lastBand = std::min(lastRow, framebuffer.height() - 1) / bandHeight;
+      for (int b = firstBand; b <= lastBand; ++b) {
+        bins[c][b].push_back(uint32_t(i));
+      }
+    }
+  });
+
+  Rect bounds = framebuffer.bounds();
+  pool.parallelFor(size_t(bands), [&](size_t b) {
+    CG_PROFILE_SCOPE("stampCircles band");
+    int firstRow = int(b) * bandHeight;
+    int lastRow = std::min(firstRow + bandHeight, framebuffer.height()) - 1;
+    Rect band = {bounds.xmin, bounds.ymax - lastRow, bounds.xmax,
+                 bounds.ymax - firstRow};
+    for (size_t c = 0; c < chunks; ++c) {
+      for (uint32_t i : bins[c][b]) {
+        const CircleCenter &center = centers[i];
+        uint32_t color = center.color.packed();
+        Rect box = {center.x + left, center.y + bottom, center.x + right,
+                    center.y + top};
+        if (band.contains(box.xmin, box.ymin) &&
+            band.contains(box.xmax, box.ymax)) {
+          uint32_t *origin = framebuffer.row(framebuffer.toRow(center.y)) +
+                             framebuffer.toColumn(center.x);
+          for (ptrdiff_t offset : pixelOffsets) {
+            origin[offset] = color;
+          }
+          for (const Span &span : spanOffsets) {
+            fillPixels(origin + span.start, span.length, color);
+          }
+          CG_PROFILE_COUNT(Pixels, stamp.pixelCount());
+        } else {
+          for (const CircleStamp::Run &run : runs) {
+            int y = center.y + run.dy;
+            if (y >= band.ymin && y <= band.ymax) {
+              framebuffer.fillSpan(center.x + run.dx0, center.x + run.dx1, y,
+                                   color);
+            }
+          }
+        }
+      }
+    }
+  });
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "framebuffer.h"
+#include "thread_pool.h"
+
+// The pixels of one midpoint circle (outline or filled), computed once as
+// horizontal runs relative to the center and then stamped at any number of
+// centers. The runs are exactly the pixels midPointCircle() / fillCircle()
+// would produce, with the eight mirrored octants merged so every pixel is
+// written once.
+class CircleStamp {
+public:
+  struct Run {
+    int dy, dx0, dx1; // inclusive, relative to the center, y up
+  };
+
+  CircleStamp(int radius, bool filled);
+
+  int radius() const { return radius_; }
+  bool filled() const { return filled_; }
+  // Runs ordered from the top row down, left to right.
+  const std::vector<Run> &runs() const { return runs_; }
+  size_t pixelCount() const { return pixelCount_; }
+
+  // Draw at (x_center, y_center) with the sink's current color.
+  void draw(PixelSink &sink, int x_center, int y_center) const;
+
+private:
+  int radius_;
+  bool filled_;
+  size_t pixelCount_ = 0;
+  std::vector<Run> runs_;
+};
+
+// Shared stamp per radius and style, built on first use. Safe to call from
+// several threads; the returned reference stays valid.
+const CircleStamp &circleStamp(int radius, bool filled);
+
+struct CircleCenter {
+  int x, y;
+  Color color;
+};
+
+// Stamp one circle at every center, in parallel. Centers are binned into
+// bands of bandHeight rows owned by one task each and drawn in input order,
+// so the result matches drawing them one after another. A circle that lies
+// entirely inside its band is written through precomputed buffer offsets
+// with no clipping; one that crosses the band or buffer edge is clipped per
+// run, so bands are taller than for segments to keep those rare.
+void stampCircles(Framebuffer &framebuffer, const CircleStamp &stamp,
+                  const CircleCenter *centers, size_t count, ThreadPool &pool,
+                  int bandHeight = 128);
+
+inline void stampCircles(Framebuffer &framebuffer, const CircleStamp &stamp,
+                         const std::vector<CircleCenter> &centers,
+                         ThreadPool &pool, int bandHeight = 128) {
+  stampCircles(framebuffer, stamp, centers.data(), centers.size(), pool,
+               bandHeight);
+}
@@ -0,0 +1,84 @@
+#include "clip.h"
+
+namespace {
+
+// One Sutherland-Hodgman stage: keep the part of in on the inside of one
+// boundary. cross(i, j) appends where the edge from vertex i to vertex j
+// meets the boundary.
+template <typename Inside, typename Cross>
+void clipStage(const PointBuffer &in, PointBuffer &out, Inside inside,
+               Cross cross) {
+  out.clear();
+  size_t n = in.size();
+  for (size_t i = 0, prev = n - 1; i < n; prev = i++) {
+    bool prevInside = inside(in.x()[prev], in.y()[prev]);
+    if (inside(in.x()[i], in.y()[i])) {
+      if (!prevInside) {
+        cross(prev, i);
+      }
+      out.push_back(in.x()[i], in.y()[i]);
+    } else if (prevInside) {
+      cross(prev, i);
+    }
+  }
+}
+
+} // namespace
+
+void clipPolygon(const Rect &clip, const PointBuffer &polygon,
+                 PointBuffer &out) {
+  out.clear();
+  if (polygon.size() < 3 || clip.empty()) {
+    return;
+  }
+  float xmin = float(clip.xmin), xmax = float(clip.xmax) + 1.0f;
+  float ymin = float(clip.ymin), ymax = float(clip.ymax) + 1.0f;
+
+  float minX = polygon.x()[0], maxX = minX;
+  float minY = polygon.y()[0], maxY = minY;
+  for (size_t i = 1; i < polygon.size(); ++i) {
+    minX = std::min(minX, polygon.x()[i]);
+    maxX = std::max(maxX, polygon.x()[i]);
+    minY = std::min(minY, polygon.y()[i]);
+    maxY = std::max(maxY, polygon.y()[i]);
+  }
+  if (maxX < xmin || minX > xmax || maxY < ymin || minY > ymax) {
+    return;
+  }
+  if (minX >= xmin && maxX <= xmax && minY >= ymin && maxY <= ymax) {
+    out = polygon;
+    return;
+  }
+
+  // Crossings take the boundary coordinate exactly, so clipped edges line up
+  // with the viewport edge.
+  auto crossX = [](const PointBuffer &in, PointBuffer &to, float x) {
+    return [&in, &to, x](size_t i, size_t j) {
+      float t = (x - in.x()[i]) / (in.x()[j] - in.x()[i]);
+      to.push_back(x, in.y()[i] + t * (in.y()[j] - in.y()[i]));
+    };
+  };
+  auto crossY = [](const PointBuffer &in, PointBuffer &to, float y) {
+    return [&in, &to, y](size_t i, size_t j) {
+      float t = (y - in.y()[i]) / (in.y()[j] - in.y()[i]);
+      to.push_back(in.x()[i] + t * (in.x()[j] - in.x()[i]), y);
+    };
+  };
+
+  PointBuffer scratch;
+  clipStage(
+      polygon, scratch, [&](float x, float) { return x >= xmin; },
+      crossX(polygon, scratch, xmin));
+  clipStage(
+      scratch, out, [&](float x, float) { return x <= xmax; },
+      crossX(scratch, out, xmax));
+  clipStage(
+      out, scratch, [&](float, float y) { return y >= ymin; },
+      crossY(out, scratch, ymin));
+  clipStage(
+      scratch, out, [&](float, float y) { return y <= ymax; },
+      crossY(scratch, out, ymax));
+  if (out.size() < 3) {
+    out.clear();
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pixel_sink.h"
+#include "rect.h"
+#include "transform.h"
+
+// Forwards to another sink and drops everything outside clip. The clipped
+// overloads in raster.h avoid generating invisible pixels in the first place;
+// this is the catch-all for everything else (fills, polar circles, callbacks).
+class ClipSink : public PixelSink {
+public:
+  ClipSink(PixelSink &sink, const Rect &clip) : sink_(sink), clip_(clip) {}
+
+  const Rect &clip() const { return clip_; }
+
+  void setColor(Color color) override { sink_.setColor(color); }
+  void plot(int x, int y) override {
+    if (clip_.contains(x, y)) {
+      sink_.plot(x, y);
+    }
+  }
+  void span(int x0, int x1, int y) override {
+    x0 = std::max(x0, clip_.xmin);
+    x1 = std::min(x1, clip_.xmax);
+    if (y >= clip_.ymin && y <= clip_.ymax && x0 <= x1) {
+      sink_.span(x0, x1, y);
+    }
+  }
+  void vspan(int x, int y0, int y1) override {
+    y0 = std::max(y0, clip_.ymin);
+    y1 = std::min(y1, clip_.ymax);
+    if (x >= clip_.xmin && x <= clip_.xmax && y0 <= y1) {
+      sink_.vspan(x, y0, y1);
+    }
+  }
+  void blend(int x, int y, uint8_t coverage) override {
+    if (clip_.contains(x, y)) {
+      sink_.blend(x, y, coverage);
+    }
+  }
+
+private:
+  PixelSink &sink_;
+  Rect clip_;
+};
+
+// Sutherland-Hodgman: clip a polygon against the area covered by clip's
+// pixels, [xmin, xmax + 1] x [ymin, ymax + 1] in continuous coordinates (the
+// same area GL shows for centeredRect()). out is empty when nothing is
+// visible. Convex polygons stay convex; concave ones may gain zero-area edges
+// along the border.
+void clipPolygon(const Rect &clip, const PointBuffer &polygon,
+                 PointBuffer &out);
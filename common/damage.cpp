@@ -0,0 +1,90 @@
+#include "damage.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Pixels an extra rectangle costs beyond its area (binning, clearing and
+// uploading it separately), so nearby small boxes are drawn as one.
+const int64_t kRectOverhead = 32 * 32;
+
+// Pixels drawn needlessly by covering a and b with their bounding box
+// instead of separately.
+int64_t mergeCost(const Rect &a, const Rect &b) {
+  return rectArea(a.unite(b)) - rectArea(a) - rectArea(b);
+}
+
+// Add box to rects, first absorbing every rectangle that is cheaper to draw
+// together with it.
+void insert(std::vector<Rect> &rects, Rect box) {
+  for (size_t i = 0; i < rects.size();) {
+    if (mergeCost(rects[i], box) <= kRectOverhead) {
+      box = box.unite(rects[i]);
+      rects[i] = rects.back();
+      rects.pop_back();
+      // The larger box may now reach rectangles checked before.
+      i = 0;
+    } else {
+      ++i;
+    }
+  }
+  rects.push_back(box);
+}
+
+} // namespace
+
+DamageTracker::DamageTracker(const Rect &bounds, size_t maxRects)
+    : bounds_(bounds), maxRects_(std::max<size_t>(maxRects, 1)) {}
+
+void DamageTracker::resize(const Rect &bounds) {
+  bounds_ = bounds;
+  full_ = true;
+}
+
+void DamageTracker::add(const Rect &box) { current_.push_back(box); }
+
+void DamageTracker::invalidate(const Rect &area) { invalid_.push_back(area); }
+
+std::vector<Rect> DamageTracker::dirtyRects() const {
+  if (full_) {
+    return bounds_.empty() ? std::vector<Rect>() : std::vector<Rect>{bounds_};
+  }
+  std::vector<Rect> rects;
+  for (const std::vector<Rect> *boxes : {&previous_, &current_, &invalid_}) {
+    for (const Rect &box : *boxes) {
+      Rect visible = box.intersect(bounds_);
+      if (!visible.empty()) {
+        insert(rects, visible);
+      }
+    }
+  }
+
+  // Over the limit: merge the pair that wastes the fewest pixels.
+  while (rects.size() > maxRects_) {
+    size_t bestI = 0, bestJ = 1;
+    int64_t best = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < rects.size(); ++i) {
+      for (size_t j = i + 1; j < rects.size(); ++j) {
+        int64_t cost = mergeCost(rects[i], rects[j]);
+        if (cost < best) {
+          best = cost;
+          bestI = i;
+          bestJ = j;
+        }
+      }
+    }
+    Rect merged = rects[bestI].unite(rects[bestJ]);
+    rects.erase(rects.begin() + bestJ);
+    rects.erase(rects.begin() + bestI);
+    insert(rects, merged);
+  }
+  return rects;
+}
+
+void DamageTracker::nextFrame() {
+  previous_.swap(current_);
+  current_.clear();
+  invalid_.clear();
+  full_ = false;
+}
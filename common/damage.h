@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rect.h"
+
+// Damage tracking for a retained software framebuffer that is updated in
+// place instead of being redrawn every frame.
+//
+// Each frame, add() the bounds of everything that moves or changes. The dirty
+// area is where those primitives were in the previous frame (to erase them)
+// and where they are now, plus anything invalidate()d. Only the dirty
+// rectangles need to be cleared, re-rasterized (static content too, clipped
+// to them) and presented, so a small animation on a large canvas costs in
+// proportion to the area that changed. Then nextFrame() starts the next one.
+//
+// The boxes are merged into at most maxRects rectangles: boxes are combined
+// whenever their common bounding box costs little more than drawing both, and
+// the cheapest pairs are combined until the limit holds.
+class DamageTracker {
+public:
+  explicit DamageTracker(const Rect &bounds, size_t maxRects = 8);
+
+  // New canvas size; the next frame is dirty everywhere.
+  void resize(const Rect &bounds);
+
+  // Bounds of a primitive drawn this frame.
+  void add(const Rect &box);
+  // Redraw area (or everything) this frame, e.g. when static content changed.
+  void invalidate(const Rect &area);
+  void invalidateAll() { full_ = true; }
+
+  // The rectangles to clear and redraw this frame, inside the bounds.
+  std::vector<Rect> dirtyRects() const;
+  // This frame's boxes become the ones to erase in the next frame.
+  void nextFrame();
+
+  const Rect &bounds() const { return bounds_; }
+
+private:
+  Rect bounds_;
+  size_t maxRects_;
+  bool full_ = true;
+  std::vector<Rect> previous_, current_, invalid_;
+};
+
+// Number of pixels in a rectangle (0 when empty).
+inline int64_t rectArea(const Rect &r) {
+  return r.empty() ? 0 : int64_t(r.xmax - r.xmin + 1) * (r.ymax - r.ymin + 1);
+}
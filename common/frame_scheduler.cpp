@@ -0,0 +1,74 @@
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Sleep granularity is coarse on most systems; spin for the last stretch.
+const std::chrono::microseconds kSpinWindow(1500);
+
+} // namespace
+
+FrameScheduler::FrameScheduler(double targetFps) { setTargetFps(targetFps); }
+
+void FrameScheduler::setTargetFps(double targetFps) {
+  targetFps_ = targetFps > 0 ? targetFps : 0;
+  period_ = targetFps_ > 0
+                ? std::chrono::duration_cast<Clock::duration>(
+                      std::chrono::duration<double>(1.0 / targetFps_))
+                : Clock::duration::zero();
+}
+
+double FrameScheduler::beginFrame() {
+  Clock::time_point now = Clock::now();
+  if (!started_) {
+    started_ = true;
+    last_ = now;
+    deadline_ = now + period_;
+    delta_ = 0;
+    return delta_;
+  }
+
+  if (period_ > Clock::duration::zero()) {
+    if (now > deadline_ + period_) {
+      // More than a frame late: drop the missed deadlines.
+      deadline_ = now;
+    }
+    if (deadline_ - now > kSpinWindow) {
+      std::this_thread::sleep_until(deadline_ - kSpinWindow);
+    }
+    while (Clock::now() < deadline_) {
+    }
+    now = std::max(Clock::now(), deadline_);
+    deadline_ += period_;
+  }
+
+  delta_ = std::chrono::duration<double>(now - last_).count();
+  last_ = now;
+  history_[frames_ % kHistory] = delta_ * 1000.0;
+  ++frames_;
+  return delta_;
+}
+
+FrameScheduler::Stats FrameScheduler::stats() const {
+  Stats stats;
+  stats.frames = frames_;
+  size_t count = size_t(std::min<uint64_t>(frames_, kHistory));
+  if (count == 0) {
+    return stats;
+  }
+
+  std::vector<double> times(history_.begin(), history_.begin() + count);
+  std::sort(times.begin(), times.end());
+  double sum = 0;
+  for (double t : times) {
+    sum += t;
+  }
+  stats.minMs = times.front();
+  stats.maxMs = times.back();
+  stats.avgMs = sum / count;
+  stats.p99Ms = times[std::min(count - 1, count * 99 / 100)];
+  return stats;
+}
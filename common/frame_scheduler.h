@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Paces a render loop to a target frame rate and measures frame times.
+//
+// beginFrame() is called once at the top of every frame. It waits until the
+// frame's deadline (sleeping most of the way and spinning for the last
+// stretch, so pacing is accurate to well under a millisecond) and returns
+// the time since the previous frame began, which animations should scale by
+// instead of assuming a fixed step. If the loop falls behind by more than a
+// frame the schedule restarts from now rather than rushing to catch up.
+class FrameScheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats {
+    uint64_t frames = 0;
+    double minMs = 0, avgMs = 0, maxMs = 0, p99Ms = 0;
+  };
+
+  // targetFps <= 0 disables pacing, e.g. when the swap interval (vsync)
+  // already limits the loop.
+  explicit FrameScheduler(double targetFps = 60.0);
+
+  void setTargetFps(double targetFps);
+  double targetFps() const { return targetFps_; }
+
+  // Returns seconds since the previous beginFrame() (0 on the first call).
+  double beginFrame();
+  double deltaTime() const { return delta_; }
+
+  // Frame-time statistics over the most recent frames.
+  Stats stats() const;
+
+private:
+  static constexpr size_t kHistory = 256;
+
+  double targetFps_ = 0;
+  Clock::duration period_{};
+  Clock::time_point last_{}, deadline_{};
+  bool started_ = false;
+  double delta_ = 0;
+
+  std::array<double, kHistory> history_{};
+  uint64_t frames_ = 0;
+};
@@ -0,0 +1,221 @@
+#include "framebuffer.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+void fillPixels(uint32_t *dst, size_t count, uint32_t value) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  __m256i v = _mm256_set1_epi32(int(value));
+  for (; i + 16 <= count; i += 16) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 8), v);
+  }
+  if (i + 8 <= count) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+    i += 8;
+  }
+#elif defined(__SSE2__)
+  __m128i v = _mm_set1_epi32(int(value));
+  for (; i + 8 <= count; i += 8) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 4), v);
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] = value;
+  }
+}
+
+Framebuffer::Framebuffer(int width, int height)
+    : width_(std::max(width, 0)), height_(std::max(height, 0)),
+      stride_((width_ + 15) & ~15),
+      pixels_(size_t(stride_) * height_, Color(255, 255, 255).packed()) {}
+
+uint32_t Framebuffer::pixel(int x, int y) const {
+  int c = toColumn(x), r = toRow(y);
+  if (unsigned(c) >= unsigned(width_) || unsigned(r) >= unsigned(height_)) {
+    return 0;
+  }
+  return row(r)[c];
+}
+
+void Framebuffer::fillSpan(int x0, int x1, int y, uint32_t color) {
+  int r = toRow(y);
+  if (unsigned(r) >= unsigned(height_)) {
+    return;
+  }
+  int c0 = std::max(toColumn(x0), 0);
+  int c1 = std::min(toColumn(x1), width_ - 1);
+  if (c0 <= c1) {
+    fillPixels(row(r) + c0, size_t(c1 - c0 + 1), color);
+    CG_PROFILE_COUNT(Pixels, c1 - c0 + 1);
+  }
+}
+
+void Framebuffer::fillVSpan(int x, int y0, int y1, uint32_t color) {
+  int c = toColumn(x);
+  if (unsigned(c) >= unsigned(width_)) {
+    return;
+  }
+  // Rows grow downwards while y grows upwards.
+  int r0 = std::max(toRow(y1), 0);
+  int r1 = std::min(toRow(y0), height_ - 1);
+  uint32_t *p = row(0) + c;
+  for (int r = r0; r <= r1; ++r) {
+    p[size_t(r) * stride_] = color;
+  }
+  CG_PROFILE_COUNT(Pixels, std::max(r1 - r0 + 1, 0));
+}
+
+void Framebuffer::clear(Color color) {
+  std::fill(pixels_.begin(), pixels_.end(), color.packed());
+  CG_PROFILE_COUNT(Pixels, size_t(width_) * height_);
+}
+
+void Framebuffer::clearRect(const Rect &area, Color color) {
+  Rect visible = area.intersect(bounds());
+  if (visible.empty()) {
+    return;
+  }
+  int c0 = toColumn(visible.xmin), c1 = toColumn(visible.xmax);
+  uint32_t value = color.packed();
+  for (int r = toRow(visible.ymax); r <= toRow(visible.ymin); ++r) {
+    fillPixels(row(r) + c0, size_t(c1 - c0 + 1), value);
+  }
+  CG_PROFILE_COUNT(Pixels, size_t(c1 - c0 + 1) *
+                               size_t(visible.ymax - visible.ymin + 1));
+}
+
+bool Framebuffer::writePPM(const std::string &path) const {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    std::cerr << "Failed to open " << path << " for writing" << std::endl;
+    return false;
+  }
+
+  out << "P6\n" << width_ << " " << height_ << "\n255\n";
+  std::vector<char> line(size_t(width_) * 3);
+  for (int r = 0; r < height_; ++r) {
+    const uint32_t *src = row(r);
+    for (int c = 0; c < width_; ++c) {
+      line[c * 3 + 0] = char(src[c] & 0xff);
+      line[c * 3 + 1] = char(src[c] >> 8 & 0xff);
+      line[c * 3 + 2] = char(src[c] >> 16 & 0xff);
+    }
+    out.write(line.data(), line.size());
+  }
+  return bool(out);
+}
+
+namespace {
+
+uint32_t crc32(const unsigned char *data, size_t size, uint32_t crc = 0) {
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      t[n] = c;
+    }
+    return t;
+  }();
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+void putBE32(std::vector<unsigned char> &out, uint32_t v) {
+  out.push_back(v >> 24);
+  out.push_back(v >> 16 & 0xff);
+  out.push_back(v >> 8 & 0xff);
+  out.push_back(v & 0xff);
+}
+
+void writeChunk(std::ofstream &out, const char *type,
+                const std::vector<unsigned char> &data) {
+  std::vector<unsigned char> chunk;
+  putBE32(chunk, uint32_t(data.size()));
+  chunk.insert(chunk.end(), type, type + 4);
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  putBE32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+  out.write(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+}
+
+} // namespace
+
+// PNG with "stored" (uncompressed) deflate blocks, so no zlib is needed.
+bool Framebuffer::writePNG(const std::string &path) const {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    std::cerr << "Failed to open " << path << " for writing" << std::endl;
+    return false;
+  }
+
+  static const unsigned char signature[8] = {0x89, 'P',  'N',  'G',
+                                             '\r', '\n', 0x1a, '\n'};
+  out.write(reinterpret_cast<const char *>(signature), 8);
+
+  std::vector<unsigned char> header;
+  putBE32(header, width_);
+  putBE32(header, height_);
+  header.push_back(8); // bit depth
+  header.push_back(6); // RGBA
+  header.push_back(0); // deflate
+  header.push_back(0); // adaptive filtering
+  header.push_back(0); // no interlace
+  writeChunk(out, "IHDR", header);
+
+  // Raw scanlines, each prefixed with filter type 0.
+  size_t rowBytes = size_t(width_) * 4 + 1;
+  std::vector<unsigned char> raw(rowBytes * height_);
+  for (int r = 0; r < height_; ++r) {
+    unsigned char *dst = raw.data() + r * rowBytes;
+    dst[0] = 0;
+    const uint32_t *src = row(r);
+    for (int c = 0; c < width_; ++c) {
+      dst[1 + c * 4 + 0] = src[c] & 0xff;
+      dst[1 + c * 4 + 1] = src[c] >> 8 & 0xff;
+      dst[1 + c * 4 + 2] = src[c] >> 16 & 0xff;
+      dst[1 + c * 4 + 3] = src[c] >> 24;
+    }
+  }
+
+  std::vector<unsigned char> zlib = {0x78, 0x01};
+  uint32_t s1 = 1, s2 = 0;
+  for (unsigned char byte : raw) {
+    s1 = (s1 + byte) % 65521;
+    s2 = (s2 + s1) % 65521;
+  }
+  size_t offset = 0;
+  do {
+    size_t len = std::min<size_t>(raw.size() - offset, 65535);
+    bool last = offset + len == raw.size();
+    zlib.push_back(last ? 1 : 0);
+    zlib.push_back(len & 0xff);
+    zlib.push_back(len >> 8);
+    zlib.push_back(~len & 0xff);
+    zlib.push_back(~len >> 8 & 0xff);
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + len);
+    offset += len;
+  } while (offset < raw.size());
+  putBE32(zlib, s2 << 16 | s1);
+  writeChunk(out, "IDAT", zlib);
+  writeChunk(out, "IEND", {});
+  return bool(out);
+}
+
+bool Framebuffer::save(const std::string &path) const {
+  bool png = path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0;
+  return png ? writePNG(path) : writePPM(path);
+}
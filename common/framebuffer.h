@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "aligned.h"
+#include "pixel_sink.h"
+#include "profiler.h"
+#include "rect.h"
+
+// Store count copies of value at dst, 8-16 pixels per iteration where SSE2 or
+// AVX2 is available.
+void fillPixels(uint32_t *dst, size_t count, uint32_t value);
+
+// src over dst with weight alpha (0-255) for each of the four channels,
+// rounded exactly, so the result is the same on every machine.
+inline uint32_t blendPixels(uint32_t dst, uint32_t src, uint32_t alpha) {
+  uint32_t rb = (src & 0xff00ff) * alpha + (dst & 0xff00ff) * (255 - alpha);
+  uint32_t ga =
+      (src >> 8 & 0xff00ff) * alpha + (dst >> 8 & 0xff00ff) * (255 - alpha);
+  // x / 255 rounded is (x + 128 + ((x + 128) >> 8)) >> 8 in each 16-bit lane.
+  rb += 0x800080;
+  ga += 0x800080;
+  rb = (rb + (rb >> 8 & 0xff00ff)) >> 8 & 0xff00ff;
+  ga = (ga + (ga >> 8 & 0xff00ff)) & 0xff00ff00;
+  return rb | ga;
+}
+
+// In-memory RGBA8 render target for running the rasterizers without a GL
+// context. Rows are padded to a whole number of cache lines and the buffer
+// itself is cache-line aligned. Pixels outside the buffer are dropped.
+class Framebuffer : public PixelSink {
+public:
+  Framebuffer(int width, int height);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  // Row pitch in pixels (>= width).
+  int stride() const { return stride_; }
+
+  uint32_t *row(int r) { return pixels_.data() + size_t(r) * stride_; }
+  const uint32_t *row(int r) const {
+    return pixels_.data() + size_t(r) * stride_;
+  }
+
+  // Map centered, y-up coordinates to a column/row in the buffer.
+  int toColumn(int x) const { return x + width_ / 2; }
+  int toRow(int y) const { return height_ / 2 - 1 - y; }
+
+  // Pixel coordinates covered by the buffer.
+  Rect bounds() const { return centeredRect(width_, height_); }
+
+  uint32_t pixel(int x, int y) const;
+  void clear(Color color);
+  // Clear only the pixels of area, e.g. the dirty parts of a retained frame.
+  void clearRect(const Rect &area, Color color);
+
+  // Writes with an explicit packed color, clipped to the buffer. These do not
+  // touch the sink's current color, so several threads can write disjoint
+  // regions at once.
+  void putPixel(int x, int y, uint32_t color) {
+    int c = toColumn(x), r = toRow(y);
+    if (unsigned(c) < unsigned(width_) && unsigned(r) < unsigned(height_)) {
+      pixels_[size_t(r) * stride_ + c] = color;
+      CG_PROFILE_COUNT(Pixels, 1);
+    }
+  }
+  void fillSpan(int x0, int x1, int y, uint32_t color);
+  void fillVSpan(int x, int y0, int y1, uint32_t color);
+  // Blend color over the pixel, weighted by its alpha times coverage / 255.
+  void blendPixel(int x, int y, uint32_t color, uint8_t coverage) {
+    int c = toColumn(x), r = toRow(y);
+    if (unsigned(c) < unsigned(width_) && unsigned(r) < unsigned(height_)) {
+      uint32_t &dst = pixels_[size_t(r) * stride_ + c];
+      dst = blendPixels(dst, color, ((color >> 24) * coverage + 127) / 255);
+      CG_PROFILE_COUNT(Pixels, 1);
+    }
+  }
+
+  void setColor(Color color) override { color_ = color.packed(); }
+  void plot(int x, int y) override { putPixel(x, y, color_); }
+  void span(int x0, int x1, int y) override { fillSpan(x0, x1, y, color_); }
+  void vspan(int x, int y0, int y1) override { fillVSpan(x, y0, y1, color_); }
+  void blend(int x, int y, uint8_t coverage) override {
+    blendPixel(x, y, color_, coverage);
+  }
+
+  bool writePPM(const std::string &path) const;
+  bool writePNG(const std::string &path) const;
+  // PNG when the path ends in ".png", binary PPM otherwise.
+  bool save(const std::string &path) const;
+
+private:
+  int width_, height_, stride_;
+  uint32_t color_ = Color().packed();
+  std::vector<uint32_t, AlignedAllocator<uint32_t>> pixels_;
+};
+
+// Sink that writes into part of a framebuffer: everything outside clip is
+// dropped. Each region keeps its own color, so threads that own disjoint
+// regions of one framebuffer never share state.
+class FramebufferRegion : public PixelSink {
+public:
+  FramebufferRegion(Framebuffer &framebuffer, const Rect &clip)
+      : framebuffer_(framebuffer),
+        clip_(clip.intersect(framebuffer.bounds())) {}
+
+  const Rect &clip() const { return clip_; }
+
+  void setColor(Color color) override { color_ = color.packed(); }
+  void plot(int x, int y) override {
+    if (clip_.contains(x, y)) {
+      framebuffer_.putPixel(x, y, color_);
+    }
+  }
+  void span(int x0, int x1, int y) override {
+    if (y >= clip_.ymin && y <= clip_.ymax) {
+      framebuffer_.fillSpan(std::max(x0, clip_.xmin), std::min(x1, clip_.xmax),
+                            y, color_);
+    }
+  }
+  void vspan(int x, int y0, int y1) override {
+    if (x >= clip_.xmin && x <= clip_.xmax) {
+      framebuffer_.fillVSpan(x, std::max(y0, clip_.ymin),
+                             std::min(y1, clip_.ymax), color_);
+    }
+  }
+  void blend(int x, int y, uint8_t coverage) override {
+    if (clip_.contains(x, y)) {
+      framebuffer_.blendPixel(x, y, color_, coverage);
+    }
+  }
+
+private:
+  Framebuffer &framebuffer_;
+  Rect clip_;
+  uint32_t color_ = Color().packed();
+};
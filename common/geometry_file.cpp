@@ -0,0 +1,255 @@
+#include "geometry_file.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "raster.h"
+
+namespace {
+
+// The sections are the in-memory arrays, so these layouts are the format.
+static_assert(sizeof(Color) == 4 && std::is_trivially_copyable<Color>::value,
+              "Color is stored as is");
+static_assert(sizeof(SceneFile::Op) == 16 &&
+                  std::is_trivially_copyable<SceneFile::Op>::value,
+              "SceneFile::Op is stored as is");
+static_assert(sizeof(Segment) == 20 &&
+                  std::is_trivially_copyable<Segment>::value,
+              "Segment is stored as is");
+
+const char kMagic[8] = {'C', 'G', 'G', 'E', 'O', 'M', '\0', '\0'};
+const uint32_t kVersion = 1;
+const uint32_t kByteOrder = 0x01020304;
+const uint64_t kAlignment = 64;
+
+enum class SectionType : uint32_t {
+  SceneOps = 1,
+  SceneParams,
+  Points,
+  Segments
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t fileSize;
+  uint32_t sectionCount;
+  int32_t width, height;
+  Color background;
+  uint8_t reserved[24];
+};
+static_assert(sizeof(Header) == 64, "header is 64 bytes");
+
+struct Section {
+  SectionType type;
+  uint32_t reserved;
+  uint64_t count;
+  uint64_t offset;
+  uint64_t bytes;
+};
+static_assert(sizeof(Section) == 32, "section entries are 32 bytes");
+
+uint64_t alignUp(uint64_t n) {
+  return (n + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// Where the y array of a Points section starts, relative to the section.
+uint64_t pointsY(uint64_t count) { return alignUp(count * sizeof(float)); }
+
+// A section's payload: up to two arrays, the second on an aligned offset.
+struct Payload {
+  SectionType type;
+  uint64_t count;
+  const void *first;
+  uint64_t firstBytes;
+  const void *second = nullptr;
+  uint64_t secondBytes = 0;
+
+  uint64_t bytes() const {
+    return second ? alignUp(firstBytes) + secondBytes : firstBytes;
+  }
+};
+
+} // namespace
+
+bool writeGeometryFile(const std::string &path, const GeometryData &data) {
+  std::vector<Payload> payloads;
+  if (data.scene.opCount > 0) {
+    payloads.push_back({SectionType::SceneOps, data.scene.opCount,
+                        data.scene.ops,
+                        data.scene.opCount * sizeof(SceneFile::Op)});
+    payloads.push_back({SectionType::SceneParams, data.scene.paramCount,
+                        data.scene.params,
+                        data.scene.paramCount * sizeof(float)});
+  }
+  if (data.pointCount > 0) {
+    uint64_t bytes = data.pointCount * sizeof(float);
+    payloads.push_back(
+        {SectionType::Points, data.pointCount, data.x, bytes, data.y, bytes});
+  }
+  if (data.segmentCount > 0) {
+    payloads.push_back({SectionType::Segments, data.segmentCount,
+                        data.segments, data.segmentCount * sizeof(Segment)});
+  }
+
+  std::vector<Section> table;
+  uint64_t offset = alignUp(sizeof(Header) + payloads.size() * sizeof(Section));
+  for (const Payload &payload : payloads) {
+    table.push_back({payload.type, 0, payload.count, offset, payload.bytes()});
+    offset = alignUp(offset + payload.bytes());
+  }
+
+  Header header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.byteOrder = kByteOrder;
+  header.fileSize = offset;
+  header.sectionCount = uint32_t(table.size());
+  header.width = data.scene.width;
+  header.height = data.scene.height;
+  header.background = data.scene.background;
+
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    std::cerr << "Failed to open " << path << " for writing" << std::endl;
+    return false;
+  }
+  const char zeros[kAlignment] = {};
+  auto pad = [&]() {
+    out.write(zeros, std::streamsize(alignUp(uint64_t(out.tellp())) -
+                                     uint64_t(out.tellp())));
+  };
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(table.data()),
+            std::streamsize(table.size() * sizeof(Section)));
+  for (const Payload &payload : payloads) {
+    pad();
+    out.write(static_cast<const char *>(payload.first),
+              std::streamsize(payload.firstBytes));
+    if (payload.second) {
+      pad();
+      out.write(static_cast<const char *>(payload.second),
+                std::streamsize(payload.secondBytes));
+    }
+  }
+  pad();
+  if (!out.flush()) {
+    std::cerr << "Failed to write " << path << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool GeometryFile::open(const std::string &path) {
+  close();
+  if (!file_.open(path)) {
+    return false;
+  }
+  auto fail = [&](const char *message) {
+    std::cerr << path << ": " << message << std::endl;
+    close();
+    return false;
+  };
+
+  const unsigned char *base = file_.data();
+  uint64_t size = file_.size();
+  if (size < sizeof(Header)) {
+    return fail("not a geometry file");
+  }
+  Header header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return fail("not a geometry file");
+  }
+  if (header.version != kVersion) {
+    return fail("unsupported geometry file version");
+  }
+  if (header.byteOrder != kByteOrder) {
+    return fail("geometry file has a different byte order");
+  }
+  if (header.fileSize != size) {
+    return fail("geometry file is truncated");
+  }
+  if (header.width < 1 || header.height < 1 || header.width > 65536 ||
+      header.height > 65536) {
+    return fail("bad scene size");
+  }
+  if (header.sectionCount > (size - sizeof(Header)) / sizeof(Section)) {
+    return fail("section table is truncated");
+  }
+  data_.scene.width = header.width;
+  data_.scene.height = header.height;
+  data_.scene.background = header.background;
+
+  // The mapping is page aligned, so the checked offsets keep every array
+  // aligned for its type.
+  const Section *table =
+      reinterpret_cast<const Section *>(base + sizeof(Header));
+  for (uint32_t i = 0; i < header.sectionCount; ++i) {
+    const Section &section = table[i];
+    uint64_t elementSize = 0;
+    switch (section.type) {
+    case SectionType::SceneOps:
+      elementSize = sizeof(SceneFile::Op);
+      break;
+    case SectionType::SceneParams:
+    case SectionType::Points:
+      elementSize = sizeof(float);
+      break;
+    case SectionType::Segments:
+      elementSize = sizeof(Segment);
+      break;
+    default:
+      continue;
+    }
+    if (section.offset % kAlignment != 0 || section.offset > size ||
+        section.bytes > size - section.offset ||
+        section.count > section.bytes / elementSize) {
+      return fail("section lies outside the file");
+    }
+    const unsigned char *start = base + section.offset;
+    switch (section.type) {
+    case SectionType::SceneOps:
+      data_.scene.ops = reinterpret_cast<const SceneFile::Op *>(start);
+      data_.scene.opCount = section.count;
+      break;
+    case SectionType::SceneParams:
+      data_.scene.params = reinterpret_cast<const float *>(start);
+      data_.scene.paramCount = section.count;
+      break;
+    case SectionType::Points:
+      if (pointsY(section.count) + section.count * sizeof(float) >
+          section.bytes) {
+        return fail("section lies outside the file");
+      }
+      data_.x = reinterpret_cast<const float *>(start);
+      data_.y = reinterpret_cast<const float *>(start + pointsY(section.count));
+      data_.pointCount = section.count;
+      break;
+    case SectionType::Segments:
+      data_.segments = reinterpret_cast<const Segment *>(start);
+      data_.segmentCount = section.count;
+      break;
+    }
+  }
+  return true;
+}
+
+void GeometryFile::close() {
+  file_.close();
+  data_ = GeometryData();
+}
+
+void renderGeometry(const GeometryData &data, Framebuffer &framebuffer) {
+  renderScene(data.scene, framebuffer);
+  Rect clip = framebuffer.bounds();
+  for (size_t i = 0; i < data.segmentCount; ++i) {
+    const Segment &s = data.segments[i];
+    framebuffer.setColor(s.color);
+    bresenhamSpans(framebuffer, clip, s.x1, s.y1, s.x2, s.y2);
+  }
+}
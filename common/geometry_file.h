@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "batch_raster.h"
+#include "framebuffer.h"
+#include "mapped_file.h"
+#include "scene_file.h"
+
+// Binary geometry that is memory-mapped and used in place: the rasterizers and
+// the transform engine read straight from the mapping, so opening a file costs
+// the same however large it is.
+//
+// Layout, in the writer's byte order (checked when opening):
+//
+//   header    64 bytes: magic "CGGEOM\0\0", version, byte order mark, file
+//             size, section count, scene size and background
+//   table     32 bytes per section: type, element count, byte offset, bytes
+//   sections  each starting on a 64-byte boundary
+//
+// Sections hold arrays of the in-memory types:
+//
+//   SceneOps     SceneFile::Op[count]      draw commands for renderScene()
+//   SceneParams  float[count]              their numbers
+//   Points       float x[count], then y[count] from the next 64-byte boundary,
+//                as PointBuffer and applyTransform() take them
+//   Segments     Segment[count]            for rasterizeSegments()
+//
+// Readers skip section types they do not know, so sections can be added
+// without a new version.
+struct GeometryData {
+  SceneView scene;
+  const float *x = nullptr, *y = nullptr;
+  size_t pointCount = 0;
+  const Segment *segments = nullptr;
+  size_t segmentCount = 0;
+};
+
+// Write data to path. Returns false (and prints why) on failure.
+bool writeGeometryFile(const std::string &path, const GeometryData &data);
+
+// Read-only view of a geometry file. Opening checks the header and that every
+// section lies inside the file; the contents are not touched until used.
+class GeometryFile {
+public:
+  GeometryFile() = default;
+  explicit GeometryFile(const std::string &path) { open(path); }
+
+  // Returns false (and prints why) if the file is missing or malformed.
+  bool open(const std::string &path);
+  void close();
+
+  bool isOpen() const { return file_.isOpen(); }
+  // Pointers into the mapping, valid while the file is open.
+  const GeometryData &data() const { return data_; }
+
+private:
+  MappedFile file_;
+  GeometryData data_;
+};
+
+// Draw the scene, then the segments in order, clipped to the framebuffer.
+void renderGeometry(const GeometryData &data, Framebuffer &framebuffer);
@@ -0,0 +1,204 @@
+#include "gl_draw.h"
+
+#include "profiler.h"
+
+namespace {
+
+GLenum toGL(PrimitiveMode mode) {
+  switch (mode) {
+  case PrimitiveMode::Points:
+    return GL_POINTS;
+  case PrimitiveMode::Lines:
+    return GL_LINES;
+  case PrimitiveMode::LineStrip:
+    return GL_LINE_STRIP;
+  case PrimitiveMode::Triangles:
+    return GL_TRIANGLES;
+  case PrimitiveMode::TriangleStrip:
+    return GL_TRIANGLE_STRIP;
+  case PrimitiveMode::TriangleFan:
+    return GL_TRIANGLE_FAN;
+  case PrimitiveMode::Quads:
+    return GL_QUADS;
+  case PrimitiveMode::Polygon:
+    return GL_POLYGON;
+  }
+  return GL_POINTS;
+}
+
+} // namespace
+
+void drawPointBatch(const PointBatch &batch) {
+  if (batch.empty()) {
+    return;
+  }
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(2, GL_SHORT, 0, batch.points().data());
+  for (size_t i = 0; i < batch.runs().size(); ++i) {
+    uint32_t count = batch.runSize(i);
+    if (count == 0) {
+      continue;
+    }
+    const Color &color = batch.runs()[i].color;
+    glColor4ub(color.r, color.g, color.b, color.a);
+    glDrawArrays(GL_POINTS, batch.runs()[i].first, count);
+    CG_PROFILE_COUNT(Vertices, count);
+    CG_PROFILE_COUNT(DrawCalls, 1);
+  }
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void drawMesh(const Mesh &mesh) {
+  if (mesh.empty()) {
+    return;
+  }
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 0, mesh.vertices.data());
+  for (const Mesh::Run &run : mesh.runs) {
+    if (run.count == 0) {
+      continue;
+    }
+    bool wide = run.lineWidth != 1.0f && (run.mode == PrimitiveMode::Lines ||
+                                          run.mode == PrimitiveMode::LineStrip);
+    if (wide) {
+      glLineWidth(run.lineWidth);
+      glEnable(GL_LINE_SMOOTH); // Enable anti-aliasing for smoother lines
+      glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+    }
+    glColor4ub(run.color.r, run.color.g, run.color.b, run.color.a);
+    glDrawArrays(toGL(run.mode), run.first, run.count);
+    CG_PROFILE_COUNT(Vertices, run.count);
+    CG_PROFILE_COUNT(DrawCalls, 1);
+    if (wide) {
+      glDisable(GL_LINE_SMOOTH);
+      glLineWidth(1.0f);
+    }
+  }
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+static_assert(sizeof(Color) == 4, "colors are passed as packed RGBA bytes");
+
+void drawInstances(const InstanceBatch &batch, InstanceVertices &scratch,
+                   ThreadPool *pool) {
+  expandInstances(batch, scratch, pool);
+  if (scratch.colors.empty()) {
+    return;
+  }
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 0, scratch.xy.data());
+  glColorPointer(4, GL_UNSIGNED_BYTE, 0, scratch.colors.data());
+  glDrawArrays(GL_TRIANGLES, 0, GLsizei(scratch.colors.size()));
+  CG_PROFILE_COUNT(Vertices, scratch.colors.size());
+  CG_PROFILE_COUNT(DrawCalls, 1);
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+GLSceneCache::~GLSceneCache() {
+  if (list_ != 0) {
+    glDeleteLists(list_, 1);
+  }
+}
+
+void GLSceneCache::draw(Scene &scene) {
+  scene.update();
+  if (list_ == 0) {
+    list_ = glGenLists(1);
+    version_ = scene.version() + 1;
+  }
+  if (version_ != scene.version()) {
+    // The draw calls count this frame's work as they are compiled; later
+    // frames count the replayed totals.
+    glNewList(list_, GL_COMPILE);
+    vertices_ = drawCalls_ = 0;
+    for (const auto &shape : scene.shapes()) {
+      drawMesh(shape->mesh());
+      drawPointBatch(shape->points());
+      for (const Mesh::Run &run : shape->mesh().runs) {
+        vertices_ += run.count;
+        drawCalls_ += run.count != 0;
+      }
+      const PointBatch &points = shape->points();
+      for (size_t i = 0; i < points.runs().size(); ++i) {
+        vertices_ += points.runSize(i);
+        drawCalls_ += points.runSize(i) != 0;
+      }
+    }
+    glEndList();
+    version_ = scene.version();
+  } else {
+    CG_PROFILE_COUNT(Vertices, vertices_);
+    CG_PROFILE_COUNT(DrawCalls, drawCalls_);
+  }
+  glCallList(list_);
+}
+
+GLFramebufferTexture::~GLFramebufferTexture() {
+  if (texture_ != 0) {
+    glDeleteTextures(1, &texture_);
+  }
+}
+
+void GLFramebufferTexture::update(const Framebuffer &framebuffer,
+                                  const std::vector<Rect> &dirty) {
+  if (texture_ == 0) {
+    glGenTextures(1, &texture_);
+  }
+  glBindTexture(GL_TEXTURE_2D, texture_);
+  // Rows in the framebuffer are stride pixels apart.
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, framebuffer.stride());
+  if (framebuffer.width() != width_ || framebuffer.height() != height_) {
+    width_ = framebuffer.width();
+    height_ = framebuffer.height();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, framebuffer.row(0));
+  } else {
+    Rect bounds = framebuffer.bounds();
+    for (const Rect &rect : dirty) {
+      Rect r = rect.intersect(bounds);
+      if (r.empty()) {
+        continue;
+      }
+      int column = framebuffer.toColumn(r.xmin);
+      int row = framebuffer.toRow(r.ymax);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, column, row, r.xmax - r.xmin + 1,
+                      r.ymax - r.ymin + 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                      framebuffer.row(row) + column);
+    }
+  }
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+void GLFramebufferTexture::draw() const {
+  if (texture_ == 0) {
+    return;
+  }
+  // Texture row 0 is the framebuffer's top row; pixel (x, y) covers
+  // [x, x + 1] x [y, y + 1] like a GL_POINT at x, y in the labs' projection.
+  float left = float(-(width_ / 2)), right = left + float(width_);
+  float top = float(height_ / 2), bottom = top - float(height_);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, texture_);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+  glBegin(GL_QUADS);
+  glTexCoord2f(0, 0);
+  glVertex2f(left, top);
+  glTexCoord2f(1, 0);
+  glVertex2f(right, top);
+  glTexCoord2f(1, 1);
+  glVertex2f(right, bottom);
+  glTexCoord2f(0, 1);
+  glVertex2f(left, bottom);
+  glEnd();
+  glDisable(GL_TEXTURE_2D);
+  CG_PROFILE_COUNT(Vertices, 4);
+  CG_PROFILE_COUNT(DrawCalls, 1);
+}
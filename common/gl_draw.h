@@ -0,0 +1,68 @@
+#pragma once
+
+#include <GL/gl.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "framebuffer.h"
+#include "instancing.h"
+#include "mesh.h"
+#include "point_batch.h"
+#include "scene.h"
+
+// Submit a whole batch as client-side vertex arrays: one glDrawArrays call per
+// color run.
+void drawPointBatch(const PointBatch &batch);
+
+// Submit a mesh with one glDrawArrays call per run.
+void drawMesh(const Mesh &mesh);
+
+// Draw every instance of the batch with a single glDrawArrays(GL_TRIANGLES)
+// call. The fixed-function pipeline the labs use has no instanced draw, so the
+// instances are expanded on the CPU (in parallel when a pool is given) into
+// one vertex and color array held in scratch.
+void drawInstances(const InstanceBatch &batch, InstanceVertices &scratch,
+                   ThreadPool *pool = nullptr);
+
+// Keeps a scene compiled into a GL display list. draw() rebuilds dirty shapes
+// and recompiles the list only when the scene version changed, so a static
+// scene costs one glCallList per frame.
+class GLSceneCache {
+public:
+  GLSceneCache() = default;
+  ~GLSceneCache();
+
+  GLSceneCache(const GLSceneCache &) = delete;
+  GLSceneCache &operator=(const GLSceneCache &) = delete;
+
+  void draw(Scene &scene);
+
+private:
+  GLuint list_ = 0;
+  uint64_t version_ = 0;
+  // Work replayed by the list, for the profiler's per-frame counters.
+  uint64_t vertices_ = 0, drawCalls_ = 0;
+};
+
+// Shows a software Framebuffer in the window through a texture. update()
+// uploads only the given rectangles (everything the first time and after a
+// resize), so a frame that changed a little sends little to the GPU; draw()
+// covers the labs' centered ortho box with the texture. The window's back
+// buffer is not kept between swaps, so drawing is always the full quad,
+// which costs the GPU next to nothing.
+class GLFramebufferTexture {
+public:
+  GLFramebufferTexture() = default;
+  ~GLFramebufferTexture();
+
+  GLFramebufferTexture(const GLFramebufferTexture &) = delete;
+  GLFramebufferTexture &operator=(const GLFramebufferTexture &) = delete;
+
+  void update(const Framebuffer &framebuffer, const std::vector<Rect> &dirty);
+  void draw() const;
+
+private:
+  GLuint texture_ = 0;
+  int width_ = 0, height_ = 0;
+};
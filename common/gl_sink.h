@@ -0,0 +1,19 @@
+#pragma once
+
+#include <GL/gl.h>
+
+#include "pixel_sink.h"
+
+// Immediate-mode GL backend: every plotted pixel becomes a GL_POINTS vertex.
+// The sink brackets its lifetime with glBegin/glEnd.
+class GLPointSink : public PixelSink {
+public:
+  GLPointSink() { glBegin(GL_POINTS); }
+  ~GLPointSink() override { glEnd(); }
+
+  GLPointSink(const GLPointSink &) = delete;
+  GLPointSink &operator=(const GLPointSink &) = delete;
+
+  void setColor(Color color) override { glColor3ub(color.r, color.g, color.b); }
+  void plot(int x, int y) override { glVertex2i(x, y); }
+};
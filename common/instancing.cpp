@@ -0,0 +1,120 @@
+#include "instancing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "profiler.h"
+#include "tile_raster.h"
+
+void expandInstances(const InstanceBatch &batch, InstanceVertices &out,
+                     ThreadPool *pool) {
+  CG_PROFILE_SCOPE("expandInstances");
+  size_t triangles = batch.trianglesPerInstance();
+  size_t vertices = triangles * 3;
+  out.xy.resize(batch.size() * vertices * 2);
+  out.colors.resize(batch.size() * vertices);
+  if (vertices == 0) {
+    return;
+  }
+
+  const PointBuffer &mesh = batch.mesh;
+  auto expand = [&](size_t i) {
+    const Transform2D &m = batch.transforms[i];
+    float *xy = out.xy.data() + i * vertices * 2;
+    auto put = [&](size_t v) {
+      auto p = m.apply(mesh.x()[v], mesh.y()[v]);
+      *xy++ = p[0];
+      *xy++ = p[1];
+    };
+    for (size_t t = 0; t < triangles; ++t) {
+      put(0);
+      put(t + 1);
+      put(t + 2);
+    }
+    std::fill_n(out.colors.begin() + i * vertices, vertices, batch.colors[i]);
+  };
+
+  if (pool) {
+    pool->parallelFor(batch.size(), expand, 256);
+  } else {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      expand(i);
+    }
+  }
+}
+
+namespace {
+
+// Every instance's triangles, in instance order, for the tiled rasterizer.
+std::vector<Triangle> instanceTriangles(const InstanceBatch &batch,
+                                        ThreadPool &pool) {
+  size_t triangles = batch.trianglesPerInstance();
+  if (batch.size() == 0 || triangles == 0) {
+    return {};
+  }
+  InstanceVertices expanded;
+  expandInstances(batch, expanded, &pool);
+
+  std::vector<Triangle> filled(batch.size() * triangles);
+  pool.parallelFor(
+      filled.size(),
+      [&](size_t t) {
+        const float *xy = expanded.xy.data() + t * 6;
+        filled[t] = {xy[0], xy[1], xy[2], xy[3], xy[4],
+                     xy[5], expanded.colors[t * 3]};
+      },
+      4096);
+  return filled;
+}
+
+} // namespace
+
+void rasterizeInstances(Framebuffer &framebuffer, const InstanceBatch &batch,
+                        ThreadPool &pool, int tileSize) {
+  rasterizeTriangles(framebuffer, instanceTriangles(batch, pool), pool,
+                     tileSize);
+}
+
+Rect instanceBounds(const InstanceBatch &batch, size_t i) {
+  const PointBuffer &mesh = batch.mesh;
+  if (mesh.empty()) {
+    return {0, 0, -1, -1};
+  }
+  const Transform2D &m = batch.transforms[i];
+  auto p = m.apply(mesh.x()[0], mesh.y()[0]);
+  float minX = p[0], maxX = p[0], minY = p[1], maxY = p[1];
+  for (size_t v = 1; v < mesh.size(); ++v) {
+    p = m.apply(mesh.x()[v], mesh.y()[v]);
+    minX = std::min(minX, p[0]);
+    maxX = std::max(maxX, p[0]);
+    minY = std::min(minY, p[1]);
+    maxY = std::max(maxY, p[1]);
+  }
+  // Conservative like the tile binning: every pixel a triangle can cover.
+  return {int(std::floor(minX)), int(std::floor(minY)), int(std::ceil(maxX)),
+          int(std::ceil(maxY))};
+}
+
+std::vector<Rect> redrawInstances(Framebuffer &framebuffer,
+                                  const InstanceBatch &batch,
+                                  DamageTracker &damage, Color background,
+                                  ThreadPool &pool, int tileSize) {
+  CG_PROFILE_SCOPE("redrawInstances");
+  for (size_t i = 0; i < batch.size(); ++i) {
+    damage.add(instanceBounds(batch, i));
+  }
+  std::vector<Rect> dirty = damage.dirtyRects();
+  damage.nextFrame();
+  if (dirty.empty()) {
+    return dirty;
+  }
+
+  std::vector<Triangle> triangles = instanceTriangles(batch, pool);
+  for (const Rect &rect : dirty) {
+    framebuffer.clearRect(rect, background);
+    rasterizeTriangles(framebuffer, rect, triangles.data(), triangles.size(),
+                       pool, tileSize);
+  }
+  return dirty;
+}
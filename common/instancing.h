@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "damage.h"
+#include "framebuffer.h"
+#include "thread_pool.h"
+#include "transform.h"
+
+// One base mesh (a convex polygon, drawn as a triangle fan) repeated with a
+// transform and color per instance.
+struct InstanceBatch {
+  PointBuffer mesh;
+  std::vector<Transform2D> transforms;
+  std::vector<Color> colors;
+
+  size_t size() const { return transforms.size(); }
+  void clear() {
+    transforms.clear();
+    colors.clear();
+  }
+  void add(const Transform2D &transform, Color color) {
+    transforms.push_back(transform);
+    colors.push_back(color);
+  }
+  size_t trianglesPerInstance() const {
+    return mesh.size() >= 3 ? mesh.size() - 2 : 0;
+  }
+};
+
+// World-space triangles for every instance: interleaved x, y per vertex and
+// one color per vertex, laid out for glVertexPointer/glColorPointer.
+struct InstanceVertices {
+  std::vector<float> xy;
+  std::vector<Color> colors;
+};
+
+// Transform every instance's mesh into out, one instance per parallel task
+// when a pool is given. Buffers are reused between calls.
+void expandInstances(const InstanceBatch &batch, InstanceVertices &out,
+                     ThreadPool *pool = nullptr);
+
+// Software backend: instances are expanded in parallel and filled with the
+// tiled triangle rasterizer in instance order, so the result does not depend
+// on the thread count.
+void rasterizeInstances(Framebuffer &framebuffer, const InstanceBatch &batch,
+                        ThreadPool &pool, int tileSize = 64);
+
+// Pixels instance i can cover: the bounding box of its transformed mesh.
+Rect instanceBounds(const InstanceBatch &batch, size_t i);
+
+// Incremental software redraw of an animated batch into a framebuffer that
+// keeps the previous frame: every instance's bounds go into damage, and only
+// the dirty rectangles are cleared to background and rasterized. Returns
+// those rectangles, for presenting just the parts that changed, and moves
+// damage on to the next frame.
+std::vector<Rect> redrawInstances(Framebuffer &framebuffer,
+                                  const InstanceBatch &batch,
+                                  DamageTracker &damage, Color background,
+                                  ThreadPool &pool, int tileSize = 64);
@@ -0,0 +1,70 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      opened_(std::exchange(other.opened_, false)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    opened_ = std::exchange(other.opened_, false);
+  }
+  return *this;
+}
+
+bool MappedFile::open(const std::string &path) {
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Failed to open " << path << ": " << strerror(errno)
+              << std::endl;
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    std::cerr << "Failed to stat " << path << ": " << strerror(errno)
+              << std::endl;
+    ::close(fd);
+    return false;
+  }
+
+  size_ = size_t(info.st_size);
+  if (size_ > 0) {
+    void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      std::cerr << "Failed to map " << path << ": " << strerror(errno)
+                << std::endl;
+      ::close(fd);
+      size_ = 0;
+      return false;
+    }
+    data_ = static_cast<const unsigned char *>(p);
+    // Sequential readers are the common case.
+    madvise(p, size_, MADV_SEQUENTIAL);
+  }
+  ::close(fd);
+  opened_ = true;
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_) {
+    munmap(const_cast<unsigned char *>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  opened_ = false;
+}
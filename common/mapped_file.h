@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (POSIX mmap). The contents stay
+// valid for the lifetime of the object.
+class MappedFile {
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string &path) { open(path); }
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  // Returns false (and prints why) if the file cannot be mapped.
+  bool open(const std::string &path);
+  void close();
+
+  bool isOpen() const { return opened_; }
+  const unsigned char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  const unsigned char *data_ = nullptr;
+  size_t size_ = 0;
+  bool opened_ = false;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "pixel_sink.h"
+
+enum class PrimitiveMode {
+  Points,
+  Lines,
+  LineStrip,
+  Triangles,
+  TriangleStrip,
+  TriangleFan,
+  Quads,
+  Polygon
+};
+
+// Tessellated 2D geometry kept on the CPU. Vertices are interleaved x, y
+// floats; each run is one glBegin/glEnd worth of vertices.
+struct Mesh {
+  struct Run {
+    PrimitiveMode mode;
+    Color color;
+    float lineWidth;
+    uint32_t first, count;
+  };
+
+  std::vector<float> vertices;
+  std::vector<Run> runs;
+
+  void clear() {
+    vertices.clear();
+    runs.clear();
+  }
+  bool empty() const { return vertices.empty(); }
+  uint32_t vertexCount() const { return uint32_t(vertices.size() / 2); }
+
+  void begin(PrimitiveMode mode, Color color, float lineWidth = 1.0f) {
+    runs.push_back({mode, color, lineWidth, vertexCount(), 0});
+  }
+  void vertex(float x, float y) {
+    vertices.push_back(x);
+    vertices.push_back(y);
+    runs.back().count++;
+  }
+};
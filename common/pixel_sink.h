@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+// 8-bit RGBA color. packed() gives the in-memory layout used by Framebuffer
+// (R, G, B, A bytes in that order).
+struct Color {
+  uint8_t r = 0, g = 0, b = 0, a = 255;
+
+  constexpr Color() = default;
+  constexpr Color(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255)
+      : r(r), g(g), b(b), a(a) {}
+
+  static constexpr Color fromFloat(float r, float g, float b) {
+    return Color(uint8_t(r * 255.0f + 0.5f), uint8_t(g * 255.0f + 0.5f),
+                 uint8_t(b * 255.0f + 0.5f));
+  }
+
+  constexpr uint32_t packed() const {
+    return uint32_t(r) | uint32_t(g) << 8 | uint32_t(b) << 16 |
+           uint32_t(a) << 24;
+  }
+};
+
+// Destination for rasterized pixels. Coordinates follow the labs' projection:
+// glOrtho(-width / 2, width / 2, -height / 2, height / 2), so (0, 0) is the
+// middle of the screen and y grows upwards.
+class PixelSink {
+public:
+  virtual ~PixelSink() = default;
+
+  virtual void setColor(Color color) = 0;
+  virtual void plot(int x, int y) = 0;
+
+  // Horizontal run x0..x1 on row y and vertical run y0..y1 in column x, both
+  // inclusive with x0 <= x1, y0 <= y1. Sinks that can write runs faster than
+  // pixel by pixel override these.
+  virtual void span(int x0, int x1, int y) {
+    for (int x = x0; x <= x1; ++x) {
+      plot(x, y);
+    }
+  }
+  virtual void vspan(int x, int y0, int y1) {
+    for (int y = y0; y <= y1; ++y) {
+      plot(x, y);
+    }
+  }
+
+  // Partially covered pixel from the anti-aliased rasterizers, coverage 0
+  // (none) to 255 (full). Sinks without blending plot pixels that are at
+  // least half covered.
+  virtual void blend(int x, int y, uint8_t coverage) {
+    if (coverage >= 128) {
+      plot(x, y);
+    }
+  }
+};
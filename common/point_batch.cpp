@@ -0,0 +1,11 @@
+#include "point_batch.h"
+
+void PointBatch::setColor(Color color) {
+  Run &last = runs_.back();
+  if (last.first == points_.size()) {
+    // Nothing drawn with the previous color yet, just replace it.
+    last.color = color;
+  } else if (last.color.packed() != color.packed()) {
+    runs_.push_back({color, uint32_t(points_.size())});
+  }
+}
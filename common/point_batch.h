@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pixel_sink.h"
+
+struct PackedPoint {
+  int16_t x, y;
+};
+
+// Collects plotted pixels into one contiguous array of int16 coordinates so a
+// whole frame's worth of points can be submitted with a handful of draw calls
+// (one per color change) instead of one glVertex call per pixel.
+class PointBatch : public PixelSink {
+public:
+  // Points [first, next run's first) are drawn with color.
+  struct Run {
+    Color color;
+    uint32_t first;
+  };
+
+  PointBatch() { clear(); }
+
+  // Drop all points but keep the allocation for the next frame.
+  void clear() {
+    points_.clear();
+    runs_.clear();
+    runs_.push_back({Color(), 0});
+  }
+  void reserve(size_t points) { points_.reserve(points); }
+
+  void setColor(Color color) override;
+  void plot(int x, int y) override {
+    // Coordinates that do not fit the packed format are far off screen.
+    if (x != int16_t(x) || y != int16_t(y)) {
+      return;
+    }
+    points_.push_back({int16_t(x), int16_t(y)});
+  }
+
+  bool empty() const { return points_.empty(); }
+  size_t size() const { return points_.size(); }
+  const std::vector<PackedPoint> &points() const { return points_; }
+  const std::vector<Run> &runs() const { return runs_; }
+  // Number of points in runs()[i].
+  uint32_t runSize(size_t i) const {
+    uint32_t end = i + 1 < runs_.size() ? runs_[i + 1].first
+                                         : uint32_t(points_.size());
+    return end - runs_[i].first;
+  }
+
+private:
+  std::vector<PackedPoint> points_;
+  std::vector<Run> runs_;
+};
@@ -0,0 +1,230 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+std::string jsonString(const char *s) {
+  std::string out = "\"";
+  for (; *s; ++s) {
+    if (*s == '"' || *s == '\\') {
+      out += '\\';
+    }
+    out += *s;
+  }
+  return out + "\"";
+}
+
+// Trace timestamps are in microseconds.
+std::string micros(int64_t ns) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.3f", ns / 1000.0);
+  return text;
+}
+
+} // namespace
+
+const char *profileCounterName(ProfileCounter counter) {
+  switch (counter) {
+  case ProfileCounter::Vertices:
+    return "vertices";
+  case ProfileCounter::DrawCalls:
+    return "draw calls";
+  case ProfileCounter::Pixels:
+    return "pixels";
+  case ProfileCounter::Count:
+    break;
+  }
+  return "?";
+}
+
+const double Profiler::kBucketMs[Profiler::kBuckets - 1] = {
+    1, 2, 4, 8, 12, 16.7, 20, 33.3, 50};
+
+Profiler::Profiler() : epoch_(Clock::now()) {}
+
+Profiler &Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+// Each thread gets its own event buffer and counters, so recording never
+// takes a lock after the first call. The profiler keeps the buffers alive
+// after their threads exit.
+Profiler::ThreadBuffer &Profiler::threadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer->id = uint32_t(threads_.size());
+    threads_.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void Profiler::record(const char *name, Clock::time_point start,
+                      Clock::time_point end) {
+  ThreadBuffer &buffer = threadBuffer();
+  if (buffer.events.size() >= kMaxEvents) {
+    ++buffer.dropped;
+    return;
+  }
+  int64_t startNs = sinceEpoch(start);
+  buffer.events.push_back({name, startNs, sinceEpoch(end) - startNs});
+}
+
+void Profiler::beginFrame() {
+  Clock::time_point now = Clock::now();
+  frameThread_ = threadBuffer().id;
+
+  // Counters only grow; a frame's work is the difference of the totals.
+  std::array<uint64_t, kCounters> totals{};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &thread : threads_) {
+      for (size_t i = 0; i < kCounters; ++i) {
+        totals[i] += thread->counters[i].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  if (inFrame_) {
+    Frame frame;
+    frame.index = frameCount_;
+    frame.ms = std::chrono::duration<double, std::milli>(now - frameStart_)
+                   .count();
+    for (size_t i = 0; i < kCounters; ++i) {
+      frame.counters[i] = totals[i] - totals_[i];
+    }
+    history_[frameCount_ % kHistory] = frame.ms;
+    ++frameCount_;
+    if (frames_.size() < kMaxEvents) {
+      int64_t startNs = sinceEpoch(frameStart_);
+      frames_.push_back({startNs, sinceEpoch(now) - startNs, frame.counters});
+    }
+    last_ = frame;
+  }
+
+  totals_ = totals;
+  frameStart_ = now;
+  inFrame_ = true;
+}
+
+Profiler::Histogram Profiler::histogram() const {
+  Histogram histogram;
+  size_t count = size_t(std::min<uint64_t>(frameCount_, kHistory));
+  histogram.frames = count;
+  if (count == 0) {
+    return histogram;
+  }
+
+  std::vector<double> times(history_.begin(), history_.begin() + count);
+  std::sort(times.begin(), times.end());
+  double sum = 0;
+  for (double t : times) {
+    sum += t;
+    size_t bucket =
+        std::upper_bound(kBucketMs, kBucketMs + kBuckets - 1, t) - kBucketMs;
+    ++histogram.buckets[bucket];
+  }
+  histogram.avgMs = sum / count;
+  histogram.p99Ms = times[std::min(count - 1, count * 99 / 100)];
+  histogram.maxMs = times.back();
+  return histogram;
+}
+
+std::string Profiler::summary() const {
+  Histogram h = histogram();
+  char text[256];
+  int n = std::snprintf(text, sizeof(text),
+                        "%.2f ms (avg %.2f, p99 %.2f, max %.2f)", last_.ms,
+                        h.avgMs, h.p99Ms, h.maxMs);
+  std::string out(text, size_t(std::max(n, 0)));
+  for (size_t i = 0; i < kCounters; ++i) {
+    out += i == 0 ? " | " : ", ";
+    out += std::to_string(last_.counters[i]) + " " +
+           profileCounterName(ProfileCounter(i));
+  }
+  return out;
+}
+
+bool Profiler::writeChromeTrace(const std::string &path) const {
+  std::ofstream out(path);
+  if (!out) {
+    std::cerr << "Failed to open " << path << " for writing" << std::endl;
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  const char *separator = "";
+  auto begin = [&](const char *name, const char *phase, uint32_t tid) {
+    out << separator << "{\"name\":" << jsonString(name) << ",\"ph\":\""
+        << phase << "\",\"pid\":1,\"tid\":" << tid;
+    separator = ",\n";
+  };
+
+  for (const auto &thread : threads_) {
+    std::string name = thread->id == frameThread_
+                           ? "render"
+                           : "worker " + std::to_string(thread->id);
+    begin("thread_name", "M", thread->id);
+    out << ",\"args\":{\"name\":" << jsonString(name.c_str()) << "}}";
+    for (const Event &event : thread->events) {
+      begin(event.name, "X", thread->id);
+      out << ",\"ts\":" << micros(event.startNs)
+          << ",\"dur\":" << micros(event.durationNs) << "}";
+    }
+  }
+  for (const FrameRecord &frame : frames_) {
+    begin("frame", "X", frameThread_);
+    out << ",\"ts\":" << micros(frame.startNs)
+        << ",\"dur\":" << micros(frame.durationNs) << "}";
+    begin("counters", "C", frameThread_);
+    out << ",\"ts\":" << micros(frame.startNs) << ",\"args\":{";
+    for (size_t i = 0; i < kCounters; ++i) {
+      out << (i ? "," : "") << jsonString(profileCounterName(ProfileCounter(i)))
+          << ":" << frame.counters[i];
+    }
+    out << "}}";
+  }
+  out << "\n]}\n";
+  return bool(out);
+}
+
+void Profiler::finish() const {
+  Histogram h = histogram();
+  std::cout << "Profile over " << h.frames << " frames: " << summary()
+            << std::endl;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    char label[32];
+    if (i + 1 < kBuckets) {
+      std::snprintf(label, sizeof(label), "  <= %5.1f ms: ", kBucketMs[i]);
+    } else {
+      std::snprintf(label, sizeof(label), "   > %5.1f ms: ",
+                    kBucketMs[kBuckets - 2]);
+    }
+    std::cout << label << h.buckets[i] << std::endl;
+  }
+
+  size_t dropped = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &thread : threads_) {
+      dropped += thread->dropped;
+    }
+  }
+  if (dropped > 0) {
+    std::cerr << "Profiler dropped " << dropped << " trace events" << std::endl;
+  }
+
+  if (const char *path = std::getenv("CG_TRACE")) {
+    if (writeChromeTrace(path)) {
+      std::cout << "Trace written to " << path << std::endl;
+    }
+  }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Lightweight instrumentation for the render loops. Use it through the
+// macros at the bottom of this file: unless CG_ENABLE_PROFILING is defined
+// (cmake -DCG_PROFILE=ON) they expand to nothing, so instrumented hot paths
+// cost nothing in normal builds.
+
+// Work counted per frame by the instrumented draw and raster paths.
+enum class ProfileCounter { Vertices, DrawCalls, Pixels, Count };
+
+const char *profileCounterName(ProfileCounter counter);
+
+class Profiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kCounters = size_t(ProfileCounter::Count);
+  // Frames kept for the frame-time statistics and histogram.
+  static constexpr size_t kHistory = 256;
+  // Trace events kept per thread (and frames kept for the trace); anything
+  // past that is counted as dropped so long sessions do not grow unbounded.
+  static constexpr size_t kMaxEvents = size_t(1) << 20;
+  // Upper edges of the frame-time histogram buckets in milliseconds; the
+  // last bucket takes everything slower.
+  static constexpr size_t kBuckets = 10;
+  static const double kBucketMs[kBuckets - 1];
+
+  struct Frame {
+    uint64_t index = 0;
+    double ms = 0;
+    std::array<uint64_t, kCounters> counters{};
+  };
+
+  struct Histogram {
+    size_t frames = 0;
+    double avgMs = 0, p99Ms = 0, maxMs = 0;
+    std::array<size_t, kBuckets> buckets{};
+  };
+
+  static Profiler &instance();
+
+  // Close the previous frame, if any, and start the next one. Call once per
+  // frame from the render loop.
+  void beginFrame();
+
+  // Counters and completed scopes may come from any thread.
+  void count(ProfileCounter counter, uint64_t n) {
+    std::atomic<uint64_t> &c = threadBuffer().counters[size_t(counter)];
+    // Each thread is the only writer of its counters, so no locked add.
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+  void record(const char *name, Clock::time_point start, Clock::time_point end);
+
+  // The last completed frame and the statistics over the recent ones.
+  const Frame &lastFrame() const { return last_; }
+  Histogram histogram() const;
+  // One line: frame time statistics and the last frame's counters.
+  std::string summary() const;
+
+  // Write the recorded scopes, frames and counters in the Chrome trace event
+  // format (load in chrome://tracing or Perfetto). Call when no instrumented
+  // work is in flight, e.g. after the render loop.
+  bool writeChromeTrace(const std::string &path) const;
+  // Print the summary and histogram, and write a trace to $CG_TRACE if set.
+  void finish() const;
+
+private:
+  struct Event {
+    const char *name;
+    int64_t startNs, durationNs;
+  };
+  struct ThreadBuffer {
+    uint32_t id = 0;
+    std::vector<Event> events;
+    size_t dropped = 0;
+    std::array<std::atomic<uint64_t>, kCounters> counters{};
+  };
+  struct FrameRecord {
+    int64_t startNs, durationNs;
+    std::array<uint64_t, kCounters> counters;
+  };
+
+  Profiler();
+  ThreadBuffer &threadBuffer();
+  int64_t sinceEpoch(Clock::time_point t) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch_)
+        .count();
+  }
+
+  Clock::time_point epoch_;
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> threads_;
+
+  // Touched only by the thread calling beginFrame().
+  bool inFrame_ = false;
+  uint32_t frameThread_ = 0;
+  uint64_t frameCount_ = 0;
+  Clock::time_point frameStart_;
+  std::array<uint64_t, kCounters> totals_{};
+  Frame last_;
+  std::array<double, kHistory> history_{};
+  std::vector<FrameRecord> frames_;
+};
+
+// Records the time from construction to destruction as a trace event. name
+// must outlive the profiler (a string literal).
+class ProfileScope {
+public:
+  explicit ProfileScope(const char *name)
+      : name_(name), start_(Profiler::Clock::now()) {}
+  ~ProfileScope() {
+    Profiler::instance().record(name_, start_, Profiler::Clock::now());
+  }
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  const char *name_;
+  Profiler::Clock::time_point start_;
+};
+
+#define CG_PROFILE_CONCAT_(a, b) a##b
+#define CG_PROFILE_CONCAT(a, b) CG_PROFILE_CONCAT_(a, b)
+
+#if defined(CG_ENABLE_PROFILING)
+#define CG_PROFILE_SCOPE(name)                                                 \
+  ProfileScope CG_PROFILE_CONCAT(cgProfileScope, __LINE__)(name)
+#define CG_PROFILE_COUNT(counter, n)                                           \
+  Profiler::instance().count(ProfileCounter::counter, uint64_t(n))
+#define CG_PROFILE_FRAME() Profiler::instance().beginFrame()
+#define CG_PROFILE_FINISH() Profiler::instance().finish()
+#else
+#define CG_PROFILE_SCOPE(name) ((void)0)
+#define CG_PROFILE_COUNT(counter, n) ((void)0)
+#define CG_PROFILE_FRAME() ((void)0)
+#define CG_PROFILE_FINISH() ((void)0)
+#endif
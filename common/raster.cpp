@@ -0,0 +1,1028 @@
+#include "raster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+#include "clip.h"
+
+namespace {
+
+// Products of two coordinate differences (up to 2^32 each) need more than 64
+// bits, so the line step-domain arithmetic is done in 128.
+using int128 = __int128;
+
+template <typename T> T floorDiv(T a, T b) {
+  T q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+template <typename T> T ceilDiv(T a, T b) { return -floorDiv(-a, b); }
+
+// Smallest i in [lo, hi] for which pred(i) holds, or hi + 1 if none does.
+// pred must be false then true over the range.
+template <typename Pred> int64_t firstTrue(int64_t lo, int64_t hi, Pred pred) {
+  int64_t end = hi + 1;
+  while (lo < end) {
+    int64_t mid = lo + (end - lo) / 2;
+    if (pred(mid)) {
+      end = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+// Steps i in [0, last] whose coordinate start + sign * i lies in [lo, hi].
+void stepRange(int64_t start, int sign, int64_t lo, int64_t hi, int64_t last,
+               int64_t &first, int64_t &end) {
+  first = std::max<int64_t>(sign > 0 ? lo - start : start - hi, 0);
+  end = std::min<int64_t>(sign > 0 ? hi - start : start - lo, last);
+}
+
+} // namespace
+
+void bresenham(PixelSink &sink, int x1, int y1, int x2, int y2) {
+  int dx = abs(x2 - x1);
+  int dy = abs(y2 - y1);
+  int sx = (x1 < x2) ? 1 : -1;
+  int sy = (y1 < y2) ? 1 : -1;
+  int x = x1, y = y1;
+
+  if (dx > dy) {
+    // Slope < 1
+    int pk = 2 * dy - dx;
+    while (x != x2) {
+      sink.plot(x, y);
+      if (pk >= 0) {
+        y += sy;
+        pk -= 2 * dx;
+      }
+      pk += 2 * dy;
+      x += sx;
+    }
+  } else {
+    // Slope >= 1
+    int pk = 2 * dx - dy;
+    while (y != y2) {
+      sink.plot(x, y);
+      if (pk >= 0) {
+        x += sx;
+        pk -= 2 * dy;
+      }
+      pk += 2 * dx;
+      y += sy;
+    }
+  }
+
+  sink.plot(x, y); // Plot the final point
+}
+
+namespace {
+
+// Walk the runs of an integer Bresenham line whose major axis advances major
+// pixels while the minor axis advances minor (0 < minor <= major). emit(n) is
+// called with the length of each run along the major axis; after each run the
+// minor coordinate steps once.
+//
+// With e the decision variable at the end of a run (0 <= e < 2 * minor) and
+// 2 * major = q * 2 * minor + r, the next run is q or q + 1 pixels long
+// depending on r > e, which follows from pk += 2 * minor per pixel and
+// pk -= 2 * major per minor step.
+template <typename Emit> void forEachRun(int major, int minor, Emit emit) {
+  int64_t major2 = 2 * int64_t(major), minor2 = 2 * int64_t(minor);
+  int64_t pk = minor2 - major;
+  int64_t k = pk >= 0 ? 0 : (-pk + minor2 - 1) / minor2;
+  int64_t e = pk + k * minor2;
+  int64_t q = major2 / minor2, r = major2 % minor2;
+
+  int64_t remaining = int64_t(major) + 1;
+  int64_t run = k + 1;
+  while (run < remaining) {
+    emit(int(run));
+    remaining -= run;
+    bool longer = r > e;
+    run = q + longer;
+    e = e - r + (longer ? minor2 : 0);
+  }
+  emit(int(remaining));
+}
+
+} // namespace
+
+void bresenhamSpans(PixelSink &sink, int x1, int y1, int x2, int y2) {
+  int dx = abs(x2 - x1);
+  int dy = abs(y2 - y1);
+  int sx = (x1 < x2) ? 1 : -1;
+  int sy = (y1 < y2) ? 1 : -1;
+  int x = x1, y = y1;
+
+  if (dx > dy) {
+    if (dy == 0) {
+      sink.span(std::min(x1, x2), std::max(x1, x2), y);
+      return;
+    }
+    forEachRun(dx, dy, [&](int n) {
+      int end = x + sx * (n - 1);
+      sink.span(std::min(x, end), std::max(x, end), y);
+      x = end + sx;
+      y += sy;
+    });
+  } else {
+    if (dx == 0) {
+      sink.vspan(x, std::min(y1, y2), std::max(y1, y2));
+      return;
+    }
+    forEachRun(dy, dx, [&](int n) {
+      int end = y + sy * (n - 1);
+      sink.vspan(x, std::min(y, end), std::max(y, end));
+      y = end + sy;
+      x += sx;
+    });
+  }
+}
+
+namespace {
+
+// Visible part of the line bresenham() draws from (x1, y1) to (x2, y2). Pixel
+// i (0 <= i <= major) is i steps along the major axis and
+// m(i) = floor((2 minor i + major) / (2 major)) steps along the minor one,
+// which is the sequence the decision term produces (pk >= 0 steps, so halves
+// round up). emit(xMajor, a0, a1, b) gets each visible run of pixels sharing
+// minor coordinate b, from major coordinate a0 to a1 in drawing order.
+template <typename Emit>
+void forEachClippedRun(const Rect &clip, int x1, int y1, int x2, int y2,
+                       Emit emit) {
+  int64_t dx = std::abs(int64_t(x2) - x1), dy = std::abs(int64_t(y2) - y1);
+  bool xMajor = dx > dy;
+  int64_t major = xMajor ? dx : dy, minor = xMajor ? dy : dx;
+  int64_t a0 = xMajor ? x1 : y1, b0 = xMajor ? y1 : x1;
+  int sa = (xMajor ? x1 < x2 : y1 < y2) ? 1 : -1;
+  int sb = (xMajor ? y1 < y2 : x1 < x2) ? 1 : -1;
+
+  // Pixel steps inside clip along the major axis, minor steps inside it
+  // along the minor one, then the pixel steps those minor steps cover.
+  int64_t i0, i1, m0, m1;
+  stepRange(a0, sa, xMajor ? clip.xmin : clip.ymin,
+            xMajor ? clip.xmax : clip.ymax, major, i0, i1);
+  stepRange(b0, sb, xMajor ? clip.ymin : clip.xmin,
+            xMajor ? clip.ymax : clip.xmax, minor, m0, m1);
+  if (i0 > i1 || m0 > m1) {
+    return;
+  }
+  if (minor == 0) {
+    emit(xMajor, int(a0 + sa * i0), int(a0 + sa * i1), int(b0));
+    return;
+  }
+  // First pixel step with m(i) >= m; at most major + 1, so it fits again.
+  auto firstStep = [&](int64_t m) {
+    return m == 0 ? int64_t(0)
+                  : int64_t(ceilDiv(2 * int128(major) * m - major,
+                                    2 * int128(minor)));
+  };
+  i0 = std::max(i0, firstStep(m0));
+  i1 = std::min(i1, firstStep(m1 + 1) - 1);
+
+  int64_t m = int64_t(floorDiv(2 * int128(minor) * i0 + major,
+                               2 * int128(major)));
+  for (int64_t i = i0; i <= i1; ++m) {
+    int64_t end = std::min(i1, firstStep(m + 1) - 1);
+    emit(xMajor, int(a0 + sa * i), int(a0 + sa * end), int(b0 + sb * m));
+    i = end + 1;
+  }
+}
+
+} // namespace
+
+void bresenham(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+               int y2) {
+  forEachClippedRun(clip, x1, y1, x2, y2, [&](bool xMajor, int a0, int a1,
+                                              int b) {
+    int step = a1 >= a0 ? 1 : -1;
+    for (int a = a0;; a += step) {
+      if (xMajor) {
+        sink.plot(a, b);
+      } else {
+        sink.plot(b, a);
+      }
+      if (a == a1) {
+        break;
+      }
+    }
+  });
+}
+
+void bresenhamSpans(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+                    int y2) {
+  forEachClippedRun(clip, x1, y1, x2, y2, [&](bool xMajor, int a0, int a1,
+                                              int b) {
+    if (xMajor) {
+      sink.span(std::min(a0, a1), std::max(a0, a1), b);
+    } else {
+      sink.vspan(b, std::min(a0, a1), std::max(a0, a1));
+    }
+  });
+}
+
+void DDA_line(PixelSink &sink, int x1, int y1, int x2, int y2) {
+  int dx = x2 - x1, dy = y2 - y1;
+  int steps = std::max(abs(dx), abs(dy));
+  float xInc = dx / float(steps), yInc = dy / float(steps);
+  float x = x1, y = y1;
+
+  for (int i = 0; i <= steps; i++) {
+    sink.plot(int(round(x)), int(round(y)));
+    x += xInc;
+    y += yInc;
+  }
+}
+
+void DDA_lineSpans(PixelSink &sink, int x1, int y1, int x2, int y2) {
+  int dx = x2 - x1, dy = y2 - y1;
+  int steps = std::max(abs(dx), abs(dy));
+  float xInc = dx / float(steps), yInc = dy / float(steps);
+  float x = x1, y = y1;
+  bool xMajor = abs(dx) >= abs(dy);
+
+  // Current run from (startX, startY) to (lastX, lastY).
+  int startX = int(round(x)), startY = int(round(y));
+  int lastX = startX, lastY = startY;
+  auto flush = [&]() {
+    if (xMajor) {
+      sink.span(std::min(startX, lastX), std::max(startX, lastX), startY);
+    } else {
+      sink.vspan(startX, std::min(startY, lastY), std::max(startY, lastY));
+    }
+  };
+
+  for (int i = 1; i <= steps; i++) {
+    x += xInc;
+    y += yInc;
+    int px = int(round(x)), py = int(round(y));
+    if ((xMajor && py != startY) || (!xMajor && px != startX)) {
+      flush();
+      startX = px;
+      startY = py;
+    }
+    lastX = px;
+    lastY = py;
+  }
+  flush();
+}
+
+namespace {
+
+// n / d rounded half away from zero like std::round, for d > 0.
+int128 roundDiv(int128 n, int128 d) {
+  return n >= 0 ? (2 * n + d) / (2 * d) : -((-2 * n + d) / (2 * d));
+}
+
+// Visible pixels of the DDA line from (x1, y1) to (x2, y2) in drawing order.
+// Step i is exactly i pixels along the major axis and round(b0 + db i /
+// steps) along the minor one; that is monotone in i, so the visible steps
+// are found by binary search. visit(xMajor, a, b) gets each pixel.
+template <typename Visit>
+void forEachClippedDDA(const Rect &clip, int x1, int y1, int x2, int y2,
+                       Visit visit) {
+  int64_t dx = int64_t(x2) - x1, dy = int64_t(y2) - y1;
+  bool xMajor = std::abs(dx) >= std::abs(dy);
+  int64_t steps = xMajor ? std::abs(dx) : std::abs(dy);
+  int64_t a0 = xMajor ? x1 : y1, b0 = xMajor ? y1 : x1;
+  int64_t db = xMajor ? dy : dx;
+  int sa = (xMajor ? dx : dy) >= 0 ? 1 : -1;
+  int64_t bMin = xMajor ? clip.ymin : clip.xmin;
+  int64_t bMax = xMajor ? clip.ymax : clip.xmax;
+  if (steps == 0) {
+    if (clip.contains(x1, y1)) {
+      visit(xMajor, int(a0), int(b0));
+    }
+    return;
+  }
+
+  auto minorAt = [&](int64_t i) {
+    return int64_t(roundDiv(int128(b0) * steps + int128(db) * i, steps));
+  };
+  int64_t i0, i1;
+  stepRange(a0, sa, xMajor ? clip.xmin : clip.ymin,
+            xMajor ? clip.xmax : clip.ymax, steps, i0, i1);
+  if (i0 > i1) {
+    return;
+  }
+  if (db >= 0) {
+    i1 = firstTrue(i0, i1, [&](int64_t i) { return minorAt(i) > bMax; }) - 1;
+    i0 = firstTrue(i0, i1, [&](int64_t i) { return minorAt(i) >= bMin; });
+  } else {
+    i1 = firstTrue(i0, i1, [&](int64_t i) { return minorAt(i) < bMin; }) - 1;
+    i0 = firstTrue(i0, i1, [&](int64_t i) { return minorAt(i) <= bMax; });
+  }
+  for (int64_t i = i0; i <= i1; ++i) {
+    visit(xMajor, int(a0 + sa * i), int(minorAt(i)));
+  }
+}
+
+bool lineInside(const Rect &clip, int x1, int y1, int x2, int y2) {
+  return clip.contains(x1, y1) && clip.contains(x2, y2);
+}
+
+} // namespace
+
+void DDA_line(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+              int y2) {
+  if (lineInside(clip, x1, y1, x2, y2)) {
+    DDA_line(sink, x1, y1, x2, y2);
+    return;
+  }
+  forEachClippedDDA(clip, x1, y1, x2, y2, [&](bool xMajor, int a, int b) {
+    if (xMajor) {
+      sink.plot(a, b);
+    } else {
+      sink.plot(b, a);
+    }
+  });
+}
+
+void DDA_lineSpans(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+                   int y2) {
+  if (lineInside(clip, x1, y1, x2, y2)) {
+    DDA_lineSpans(sink, x1, y1, x2, y2);
+    return;
+  }
+  // Current run along the major axis from runStart to runEnd at runB.
+  bool open = false, runXMajor = true;
+  int runStart = 0, runEnd = 0, runB = 0;
+  auto flush = [&]() {
+    if (!open) {
+      return;
+    }
+    int lo = std::min(runStart, runEnd), hi = std::max(runStart, runEnd);
+    if (runXMajor) {
+      sink.span(lo, hi, runB);
+    } else {
+      sink.vspan(runB, lo, hi);
+    }
+  };
+  forEachClippedDDA(clip, x1, y1, x2, y2, [&](bool xMajor, int a, int b) {
+    if (!open || b != runB) {
+      flush();
+      open = true;
+      runXMajor = xMajor;
+      runStart = a;
+      runB = b;
+    }
+    runEnd = a;
+  });
+  flush();
+}
+
+void drawLineDDA(PixelSink &sink, float start_x, float start_y, float end_x,
+                 float end_y) {
+  float step_size = std::max(std::fabs(end_x - start_x),
+                             std::fabs(end_y - start_y));
+  float x_inc = (end_x - start_x) / step_size;
+  float y_inc = (end_y - start_y) / step_size;
+
+  int i = 0;
+  while (i != step_size) {
+    // GL places a float vertex in the pixel that contains it.
+    sink.plot(int(std::floor(start_x)), int(std::floor(start_y)));
+    start_x += x_inc;
+    start_y += y_inc;
+    i++;
+  }
+}
+
+void draw8SymmetricPoints(PixelSink &sink, int x_center, int y_center, int x,
+                          int y) {
+  sink.plot(x_center + x, y_center + y);
+  sink.plot(x_center - x, y_center + y);
+  sink.plot(x_center + x, y_center - y);
+  sink.plot(x_center - x, y_center - y);
+  sink.plot(x_center + y, y_center + x);
+  sink.plot(x_center - y, y_center + x);
+  sink.plot(x_center + y, y_center - x);
+  sink.plot(x_center - y, y_center - x);
+}
+
+void draw4SymmetricPoints(PixelSink &sink, int x_center, int y_center, int x,
+                          int y) {
+  sink.plot(x_center + x, y_center + y);
+  sink.plot(x_center - x, y_center + y);
+  sink.plot(x_center + x, y_center - y);
+  sink.plot(x_center - x, y_center - y);
+}
+
+void midPointCircle(PixelSink &sink, int x_center, int y_center, int radius) {
+  int x = 0, y = radius;
+  int pk = 1 - radius;
+  draw8SymmetricPoints(sink, x_center, y_center, x, y);
+
+  while (!(x >= y)) {
+    if (pk < 0) {
+      x = x + 1;
+      pk = pk + 2 * x + 1;
+    } else {
+      x = x + 1;
+      y = y - 1;
+      pk = pk + 2 * x - 2 * y + 1;
+    }
+    draw8SymmetricPoints(sink, x_center, y_center, x, y);
+  }
+}
+
+namespace {
+
+// Floor of the square root, for v < 2^126.
+int64_t isqrt(int128 v) {
+  if (v <= 0) {
+    return 0;
+  }
+  int128 s = int128(std::sqrt(double(v)));
+  while (s * s > v) {
+    --s;
+  }
+  while ((s + 1) * (s + 1) <= v) {
+    ++s;
+  }
+  return int64_t(s);
+}
+
+// y of midPointCircle()'s walk at x. Each step keeps y while the midpoint
+// (x, y - 1/2) is inside the circle, so y is the largest integer with
+// x^2 + (y - 1/2)^2 < r^2. The integer pk = 1 - r is the textbook 5/4 - r
+// shifted by 1/4, which never changes its sign test. 4 r^2 needs 64 bits
+// for int radii.
+int64_t circleY(int64_t r, int64_t x) {
+  return (isqrt(4 * (int128(r) * r - int128(x) * x) - 1) + 1) / 2;
+}
+
+} // namespace
+
+void midPointCircle(PixelSink &sink, const Rect &clip, int x_center,
+                    int y_center, int radius) {
+  int64_t xc = x_center, yc = y_center, r = radius;
+  if (r < 0) {
+    ClipSink clipped(sink, clip);
+    midPointCircle(clipped, x_center, y_center, radius);
+    return;
+  }
+  if (xc + r < clip.xmin || xc - r > clip.xmax || yc + r < clip.ymin ||
+      yc - r > clip.ymax) {
+    return;
+  }
+  if (xc - r >= clip.xmin && xc + r <= clip.xmax && yc - r >= clip.ymin &&
+      yc + r <= clip.ymax) {
+    midPointCircle(sink, x_center, y_center, radius);
+    return;
+  }
+
+  // The walk runs x = 0 .. last with y = circleY(x) falling. Octant o plots
+  // (x, y) or, swapped, (y, x) with the signs (su, sv).
+  int64_t last = firstTrue(0, r, [&](int64_t x) { return x >= circleY(r, x); });
+  static const int octants[8][3] = {{1, 1, 0},  {-1, 1, 0}, {1, -1, 0},
+                                    {-1, -1, 0}, {1, 1, 1},  {-1, 1, 1},
+                                    {1, -1, 1},  {-1, -1, 1}};
+  for (const int *octant : octants) {
+    int su = octant[0], sv = octant[1];
+    bool swap = octant[2];
+    // The coordinate that follows x gives a range of x directly; the one
+    // that follows y gives a range of y, and y falls as x grows.
+    int64_t x0, x1, y0, y1;
+    stepRange(swap ? yc : xc, swap ? sv : su, swap ? clip.ymin : clip.xmin,
+              swap ? clip.ymax : clip.xmax, last, x0, x1);
+    stepRange(swap ? xc : yc, swap ? su : sv, swap ? clip.xmin : clip.ymin,
+              swap ? clip.xmax : clip.ymax, r, y0, y1);
+    x0 = std::max(x0, firstTrue(0, last, [&](int64_t x) {
+                    return circleY(r, x) <= y1;
+                  }));
+    x1 = std::min(x1, firstTrue(0, last, [&](int64_t x) {
+                        return circleY(r, x) < y0;
+                      }) - 1);
+    if (x0 > x1) {
+      continue;
+    }
+
+    // Resume the walk at x0; pk is the decision for the step after (x, y).
+    // Its terms need 128 bits, the difference stays within a few r.
+    int64_t x = x0, y = circleY(r, x0);
+    int64_t pk = int64_t(int128(x + 1) * (x + 1) + int128(y) * y - y -
+                         int128(r) * r);
+    for (;;) {
+      if (swap) {
+        sink.plot(int(xc + su * y), int(yc + sv * x));
+      } else {
+        sink.plot(int(xc + su * x), int(yc + sv * y));
+      }
+      if (x == x1) {
+        break;
+      }
+      x = x + 1;
+      if (pk < 0) {
+        pk = pk + 2 * x + 1;
+      } else {
+        y = y - 1;
+        pk = pk + 2 * x - 2 * y + 1;
+      }
+    }
+  }
+}
+
+namespace {
+
+// State of the midpoint ellipse walk over the first quadrant, from (0, ry)
+// to (rx, 0). The decision parameter is the lab's float one scaled by 4 so
+// the 0.25 and 0.5 terms are integers, and it is advanced by second-order
+// differences: dx = 8 ry^2 x and dy = 8 rx^2 y change by constants per step,
+// so a step has no multiplications. Near the outline pk stays within a few
+// of those steps, so int64 holds it up to kMaxEllipseRadius; entering a
+// region evaluates its 4 rx^2 ry^2 terms in 128 bits. Each region can be
+// entered at any point of the walk, since pk only depends on (x, y) there.
+struct EllipseWalk {
+  int64_t a2, b2, stepDx, stepDy;
+  int x = 0, y = 0;
+  int64_t dx = 0, dy = 0, pk = 0;
+
+  EllipseWalk(int rx, int ry)
+      : a2(int64_t(rx) * rx), b2(int64_t(ry) * ry), stepDx(8 * b2),
+        stepDy(8 * a2) {}
+
+  void moveTo(int px, int py) {
+    x = px;
+    y = py;
+    dx = stepDx * x;
+    dy = stepDy * y;
+  }
+
+  // Region 1: slope above -1, x steps every time.
+  void startRegion1(int px, int py) {
+    moveTo(px, py);
+    int128 u = int128(x) + 1, v = 2 * int128(y) - 1;
+    pk = int64_t(4 * b2 * u * u + a2 * v * v - 4 * int128(a2) * b2);
+  }
+  bool inRegion1() const { return dx < dy; }
+  void stepRegion1() {
+    x++;
+    dx += stepDx;
+    if (pk < 0) {
+      pk += dx + 4 * b2;
+    } else {
+      y--;
+      dy -= stepDy;
+      pk += dx - dy + 4 * b2;
+    }
+  }
+
+  // Region 2: y steps every time.
+  void startRegion2(int px, int py) {
+    moveTo(px, py);
+    int128 u = 2 * int128(x) + 1, v = int128(y) - 1;
+    pk = int64_t(b2 * u * u + 4 * a2 * v * v - 4 * int128(a2) * b2);
+  }
+  void stepRegion2() {
+    y--;
+    dy -= stepDy;
+    if (pk > 0) {
+      pk += 4 * a2 - dy;
+    } else {
+      x++;
+      dx += stepDx;
+      pk += dx - dy + 4 * a2;
+    }
+  }
+};
+
+// Radii the walk draws exactly; see kMaxEllipseRadius.
+bool ellipseRadiiValid(int rx, int ry) {
+  return rx >= 0 && ry >= 0 && rx <= kMaxEllipseRadius &&
+         ry <= kMaxEllipseRadius;
+}
+
+// The whole walk, calling visit(x, y) for every point until it returns
+// false.
+template <typename Visit> void walkEllipse(int rx, int ry, Visit visit) {
+  EllipseWalk walk(rx, ry);
+  walk.startRegion1(0, ry);
+  if (!visit(walk.x, walk.y)) {
+    return;
+  }
+  while (walk.inRegion1()) {
+    walk.stepRegion1();
+    if (!visit(walk.x, walk.y)) {
+      return;
+    }
+  }
+  walk.startRegion2(walk.x, walk.y);
+  while (walk.y > 0) {
+    walk.stepRegion2();
+    if (!visit(walk.x, walk.y)) {
+      return;
+    }
+  }
+}
+
+// Closed forms of the walk, for a2 = rx^2 > 0 and b2 = ry^2 > 0, evaluated
+// in 128 bits. Region 1 keeps y while the midpoint (x, y - 1/2) is strictly
+// inside, so there y is the largest integer with
+// b2 x^2 + a2 (y - 1/2)^2 < a2 b2...
+int64_t ellipseY(int64_t a2, int64_t b2, int64_t x) {
+  int128 n = 4 * int128(b2) * (a2 - int128(x) * x);
+  return (isqrt(ceilDiv(n, int128(a2)) - 1) + 1) / 2;
+}
+
+// ...except at the last point of region 1, where the outline may already be
+// steeper than the one step y can fall per x.
+int64_t region1Y(int64_t a2, int64_t b2, int64_t x, int ry) {
+  return x == 0 ? ry
+                : std::max(ellipseY(a2, b2, x), ellipseY(a2, b2, x - 1) - 1);
+}
+
+// Region 2 keeps x while the midpoint (x + 1/2, y) is outside, so x is the
+// smallest integer with b2 (x + 1/2)^2 + a2 y^2 > a2 b2, but never less than
+// where region 1 ended.
+int64_t region2X(int64_t a2, int64_t b2, int64_t y, int64_t xEnd) {
+  int128 n = 4 * int128(a2) * (b2 - int128(y) * y);
+  return std::max(xEnd, (isqrt(n / b2) + 1) / 2);
+}
+
+} // namespace
+
+void midPointEllipse(PixelSink &sink, int x_center, int y_center, int rx,
+                     int ry) {
+  if (!ellipseRadiiValid(rx, ry)) {
+    return;
+  }
+  // Consecutive points on one row (region 1) or one column (region 2) are
+  // merged and drawn as four mirrored spans instead of four plots each.
+  enum { Single, Row, Column } run = Single;
+  int startX = 0, startY = ry, lastX = 0, lastY = ry;
+  auto flush = [&]() {
+    if (run == Row) {
+      sink.span(x_center + startX, x_center + lastX, y_center + lastY);
+      sink.span(x_center - lastX, x_center - startX, y_center + lastY);
+      sink.span(x_center + startX, x_center + lastX, y_center - lastY);
+      sink.span(x_center - lastX, x_center - startX, y_center - lastY);
+    } else if (run == Column) {
+      sink.vspan(x_center + lastX, y_center + lastY, y_center + startY);
+      sink.vspan(x_center - lastX, y_center + lastY, y_center + startY);
+      sink.vspan(x_center + lastX, y_center - startY, y_center - lastY);
+      sink.vspan(x_center - lastX, y_center - startY, y_center - lastY);
+    } else {
+      draw4SymmetricPoints(sink, x_center, y_center, lastX, lastY);
+    }
+  };
+  walkEllipse(rx, ry, [&](int x, int y) {
+    if (x == 0 && y == ry) {
+      return true; // the starting point, already pending
+    }
+    if (y == lastY && run != Column) {
+      run = Row;
+    } else if (x == lastX && run != Row) {
+      run = Column;
+    } else {
+      flush();
+      run = Single;
+      startX = x;
+      startY = y;
+    }
+    lastX = x;
+    lastY = y;
+    return true;
+  });
+  flush();
+}
+
+void midPointEllipse(PixelSink &sink, const Rect &clip, int x_center,
+                     int y_center, int rx, int ry) {
+  int64_t xc = x_center, yc = y_center;
+  if (!ellipseRadiiValid(rx, ry) || xc + rx < clip.xmin ||
+      xc - rx > clip.xmax || yc + ry < clip.ymin || yc - ry > clip.ymax) {
+    return;
+  }
+  if (xc - rx >= clip.xmin && xc + rx <= clip.xmax && yc - ry >= clip.ymin &&
+      yc + ry <= clip.ymax) {
+    midPointEllipse(sink, x_center, y_center, rx, ry);
+    return;
+  }
+
+  if (rx == 0 || ry == 0) {
+    // With rx = 0 the walk is the vertical axis, with ry = 0 the center.
+    ClipSink clipped(sink, clip);
+    clipped.vspan(x_center, int(yc - ry), int(yc + ry));
+    return;
+  }
+
+  // Region 1 runs x = 0 .. xEnd with y = region1Y(x) falling, region 2 runs
+  // y = yEnd - 1 .. 0 with x = region2X(y) growing. Quadrant (sx, sy) plots
+  // them mirrored; in each region the steps whose x and y are both inside
+  // clip are found by binary search and the walk resumes at the first one.
+  const int64_t a2 = int64_t(rx) * rx, b2 = int64_t(ry) * ry;
+  int64_t xEnd = firstTrue(0, rx, [&](int64_t x) {
+    return b2 * x >= a2 * region1Y(a2, b2, x, ry);
+  });
+  int64_t yEnd = region1Y(a2, b2, xEnd, ry);
+  EllipseWalk walk(rx, ry);
+  for (int sx : {1, -1}) {
+    for (int sy : {1, -1}) {
+      int64_t x0, x1, y0, y1;
+      stepRange(xc, sx, clip.xmin, clip.xmax, rx, x0, x1);
+      stepRange(yc, sy, clip.ymin, clip.ymax, ry, y0, y1);
+      if (x0 > x1 || y0 > y1) {
+        continue;
+      }
+
+      int64_t first = std::max(x0, firstTrue(0, xEnd, [&](int64_t x) {
+                                 return region1Y(a2, b2, x, ry) <= y1;
+                               }));
+      int64_t last = std::min(x1, firstTrue(0, xEnd, [&](int64_t x) {
+                                return region1Y(a2, b2, x, ry) < y0;
+                              }) - 1);
+      if (first <= last) {
+        walk.startRegion1(int(first), int(region1Y(a2, b2, first, ry)));
+        for (;;) {
+          sink.plot(int(xc + sx * walk.x), int(yc + sy * walk.y));
+          if (walk.x == last) {
+            break;
+          }
+          walk.stepRegion1();
+        }
+      }
+
+      // Region 2 by y, which falls as x grows.
+      int64_t top = std::min(y1, firstTrue(0, yEnd - 1, [&](int64_t y) {
+                               return region2X(a2, b2, y, xEnd) < x0;
+                             }) - 1);
+      int64_t bottom = std::max(y0, firstTrue(0, yEnd - 1, [&](int64_t y) {
+                                  return region2X(a2, b2, y, xEnd) <= x1;
+                                }));
+      if (bottom <= top) {
+        walk.startRegion2(int(region2X(a2, b2, top, xEnd)), int(top));
+        for (;;) {
+          sink.plot(int(xc + sx * walk.x), int(yc + sy * walk.y));
+          if (walk.y == bottom) {
+            break;
+          }
+          walk.stepRegion2();
+        }
+      }
+    }
+  }
+}
+
+void polarCoordinateCircle(PixelSink &sink, int x_center, int y_center,
+                           int radius) {
+  // One-degree steps, computed once with the lab's original angle formula
+  // so the plotted points stay the same.
+  struct Table {
+    double c[360], s[360];
+    Table() {
+      for (int i = 0; i < 360; i++) {
+        float theta = i * 3.14159 / 180;
+        c[i] = cos(theta);
+        s[i] = sin(theta);
+      }
+    }
+  };
+  static const Table table;
+
+  for (int i = 0; i < 360; i++) {
+    int x = radius * table.c[i];
+    int y = radius * table.s[i];
+    sink.plot(x + x_center, y + y_center);
+  }
+}
+
+namespace {
+
+// Span across row y_center + row and its mirror y_center - row.
+void spanPair(PixelSink &sink, int x_center, int y_center, int row,
+              int halfWidth) {
+  sink.span(x_center - halfWidth, x_center + halfWidth, y_center + row);
+  if (row != 0) {
+    sink.span(x_center - halfWidth, x_center + halfWidth, y_center - row);
+  }
+}
+
+} // namespace
+
+void fillCircle(PixelSink &sink, int x_center, int y_center, int radius) {
+  if (radius < 0) {
+    return;
+  }
+  // Same walk as midPointCircle(). Row x of the octant spans +-y; row y is
+  // final once y is about to step down, and is skipped when the mirrored row
+  // x covers it.
+  int x = 0, y = radius;
+  int pk = 1 - radius;
+  spanPair(sink, x_center, y_center, x, y);
+
+  while (!(x >= y)) {
+    if (pk < 0) {
+      x = x + 1;
+      pk = pk + 2 * x + 1;
+    } else {
+      x = x + 1;
+      y = y - 1;
+      pk = pk + 2 * x - 2 * y + 1;
+      if (y + 1 > x) {
+        spanPair(sink, x_center, y_center, y + 1, x - 1);
+      }
+    }
+    spanPair(sink, x_center, y_center, x, y);
+  }
+}
+
+void fillEllipse(PixelSink &sink, int x_center, int y_center, int rx,
+                 int ry) {
+  if (!ellipseRadiiValid(rx, ry)) {
+    return;
+  }
+  // x never decreases along the walk, so the last point before y steps down
+  // is the widest outline pixel on that row.
+  int rowY = ry, rowX = 0;
+  walkEllipse(rx, ry, [&](int x, int y) {
+    if (y != rowY) {
+      spanPair(sink, x_center, y_center, rowY, rowX);
+      rowY = y;
+    }
+    rowX = x;
+    return true;
+  });
+  spanPair(sink, x_center, y_center, rowY, rowX);
+}
+
+namespace {
+
+// Rows yc - ry .. yc + ry of a filled shape that lie in clip, each spanning
+// xc +- halfWidth(|row - yc|) cut to clip. Coordinates are int64 so shapes
+// reaching past the int range only ever produce clip's pixels.
+template <typename HalfWidth>
+void fillClippedRows(PixelSink &sink, const Rect &clip, int64_t xc,
+                     int64_t yc, int64_t ry, HalfWidth halfWidth) {
+  int64_t top = std::max<int64_t>(yc - ry, clip.ymin);
+  int64_t bottom = std::min<int64_t>(yc + ry, clip.ymax);
+  for (int64_t row = top; row <= bottom; ++row) {
+    int64_t w = halfWidth(row < yc ? yc - row : row - yc);
+    int64_t x0 = std::max<int64_t>(xc - w, clip.xmin);
+    int64_t x1 = std::min<int64_t>(xc + w, clip.xmax);
+    if (x0 <= x1) {
+      sink.span(int(x0), int(x1), int(row));
+    }
+  }
+}
+
+} // namespace
+
+void fillCircle(PixelSink &sink, const Rect &clip, int x_center,
+                int y_center, int radius) {
+  int64_t xc = x_center, yc = y_center, r = radius;
+  if (r < 0 || xc + r < clip.xmin || xc - r > clip.xmax ||
+      yc + r < clip.ymin || yc - r > clip.ymax) {
+    return;
+  }
+  if (xc - r >= clip.xmin && xc + r <= clip.xmax && yc - r >= clip.ymin &&
+      yc + r <= clip.ymax) {
+    fillCircle(sink, x_center, y_center, radius);
+    return;
+  }
+  // Rows up to last are the walk's x rows, spanning +-y; at last the walk's
+  // y may still be one above circleY(), as it falls by one step at most.
+  // Each row beyond is drawn as y steps down from it, out to the last x it
+  // held.
+  int64_t last = firstTrue(0, r, [&](int64_t x) { return x >= circleY(r, x); });
+  fillClippedRows(sink, clip, xc, yc, r, [&](int64_t d) {
+    if (d <= last) {
+      return d == 0 ? r : std::max(circleY(r, d), circleY(r, d - 1) - 1);
+    }
+    return firstTrue(0, last, [&](int64_t x) { return circleY(r, x) < d; }) -
+           1;
+  });
+}
+
+void fillEllipse(PixelSink &sink, const Rect &clip, int x_center,
+                 int y_center, int rx, int ry) {
+  int64_t xc = x_center, yc = y_center;
+  if (!ellipseRadiiValid(rx, ry) || xc + rx < clip.xmin ||
+      xc - rx > clip.xmax || yc + ry < clip.ymin || yc - ry > clip.ymax) {
+    return;
+  }
+  if (xc - rx >= clip.xmin && xc + rx <= clip.xmax && yc - ry >= clip.ymin &&
+      yc + ry <= clip.ymax) {
+    fillEllipse(sink, x_center, y_center, rx, ry);
+    return;
+  }
+  if (rx == 0 || ry == 0) {
+    // With rx = 0 the walk is the vertical axis, with ry = 0 the center.
+    fillClippedRows(sink, clip, xc, yc, ry, [](int64_t) { return 0; });
+    return;
+  }
+  // Rows from yEnd up end at the last region 1 point on them, rows below at
+  // the one region 2 point; see midPointEllipse().
+  const int64_t a2 = int64_t(rx) * rx, b2 = int64_t(ry) * ry;
+  int64_t xEnd = firstTrue(0, rx, [&](int64_t x) {
+    return b2 * x >= a2 * region1Y(a2, b2, x, ry);
+  });
+  int64_t yEnd = region1Y(a2, b2, xEnd, ry);
+  fillClippedRows(sink, clip, xc, yc, ry, [&](int64_t d) {
+    if (d < yEnd) {
+      return region2X(a2, b2, d, xEnd);
+    }
+    return firstTrue(0, xEnd, [&](int64_t x) {
+             return region1Y(a2, b2, x, ry) < d;
+           }) -
+           1;
+  });
+}
+
+namespace {
+
+const int64_t kSubpixel = 256;
+
+} // namespace
+
+void fillTriangle(PixelSink &sink, float x0, float y0, float x1, float y1,
+                  float x2, float y2) {
+  const int limit = std::numeric_limits<int>::max();
+  fillTriangle(sink, Rect{-limit, -limit, limit, limit}, x0, y0, x1, y1, x2,
+               y2);
+}
+
+void fillTriangle(PixelSink &sink, const Rect &clip, float x0, float y0,
+                  float x1, float y1, float x2, float y2) {
+  int64_t X[3] = {std::llround(x0 * kSubpixel), std::llround(x1 * kSubpixel),
+                  std::llround(x2 * kSubpixel)};
+  int64_t Y[3] = {std::llround(y0 * kSubpixel), std::llround(y1 * kSubpixel),
+                  std::llround(y2 * kSubpixel)};
+
+  // Counter-clockwise winding keeps the interior on the left of every edge.
+  int64_t area = (X[1] - X[0]) * (Y[2] - Y[0]) - (Y[1] - Y[0]) * (X[2] - X[0]);
+  if (area == 0) {
+    return;
+  }
+  if (area < 0) {
+    std::swap(X[1], X[2]);
+    std::swap(Y[1], Y[2]);
+  }
+
+  // Edge i runs from vertex i to vertex i + 1. With y up, top edges run in -x
+  // and left edges run downwards; pixels exactly on any other edge are left
+  // to the neighbouring triangle.
+  int64_t dX[3], dY[3], bias[3];
+  for (int i = 0; i < 3; ++i) {
+    int j = (i + 1) % 3;
+    dX[i] = X[j] - X[i];
+    dY[i] = Y[j] - Y[i];
+    bool topLeft = dY[i] < 0 || (dY[i] == 0 && dX[i] < 0);
+    bias[i] = topLeft ? 0 : 1;
+  }
+
+  const int64_t half = kSubpixel / 2;
+  int64_t minY = std::min({Y[0], Y[1], Y[2]});
+  int64_t maxY = std::max({Y[0], Y[1], Y[2]});
+  int64_t minX = std::min({X[0], X[1], X[2]});
+  int64_t maxX = std::max({X[0], X[1], X[2]});
+  int64_t firstRow = std::max<int64_t>(ceilDiv(minY - half, kSubpixel),
+                                       clip.ymin);
+  int64_t lastRow =
+      std::min<int64_t>(floorDiv(maxY - half, kSubpixel), clip.ymax);
+  int64_t firstCol = std::max<int64_t>(ceilDiv(minX - half, kSubpixel),
+                                       clip.xmin);
+  int64_t lastCol =
+      std::min<int64_t>(floorDiv(maxX - half, kSubpixel), clip.xmax);
+
+  for (int64_t row = firstRow; row <= lastRow; ++row) {
+    int64_t py = row * kSubpixel + half;
+    int64_t left = firstCol, right = lastCol;
+    // E(x) = dX * (py - Y) - dY * (x * kSubpixel + half - X) >= bias
+    for (int i = 0; i < 3 && left <= right; ++i) {
+      int64_t k = dX[i] * (py - Y[i]) - dY[i] * (half - X[i]) - bias[i];
+      if (dY[i] == 0) {
+        if (k < 0) {
+          left = right + 1;
+        }
+      } else if (dY[i] > 0) {
+        right = std::min(right, floorDiv(k, dY[i] * kSubpixel));
+      } else {
+        left = std::max(left, ceilDiv(k, dY[i] * kSubpixel));
+      }
+    }
+    if (left <= right) {
+      sink.span(int(left), int(right), int(row));
+    }
+  }
+}
+
+void fillConvexPolygon(PixelSink &sink, const float *x, const float *y,
+                       size_t count) {
+  for (size_t i = 2; i < count; ++i) {
+    fillTriangle(sink, x[0], y[0], x[i - 1], y[i - 1], x[i], y[i]);
+  }
+}
+
+void fillConvexPolygon(PixelSink &sink, const Rect &clip, const float *x,
+                       const float *y, size_t count) {
+  for (size_t i = 2; i < count; ++i) {
+    fillTriangle(sink, clip, x[0], y[0], x[i - 1], y[i - 1], x[i], y[i]);
+  }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+
+#include "pixel_sink.h"
+#include "rect.h"
+
+// Scan-conversion algorithms from the labs. They write through a PixelSink so
+// the same code drives the GL window (GLPointSink) or an in-memory
+// Framebuffer. The caller chooses the color with sink.setColor().
+
+// Integer Bresenham line, both endpoints included.
+void bresenham(PixelSink &sink, int x1, int y1, int x2, int y2);
+
+// Same pixels as bresenham(), produced as horizontal (|slope| < 1) or vertical
+// runs. Run lengths come from an incremental error term, so there is no
+// per-pixel branch and sinks can fill each run in one go.
+void bresenhamSpans(PixelSink &sink, int x1, int y1, int x2, int y2);
+
+// DDA line with rounding to the nearest pixel, both endpoints included.
+void DDA_line(PixelSink &sink, int x1, int y1, int x2, int y2);
+
+// Same pixels as DDA_line(), with consecutive pixels on one row or column
+// merged into spans.
+void DDA_lineSpans(PixelSink &sink, int x1, int y1, int x2, int y2);
+
+// Clipped versions: only the pixels of the full line that fall inside clip
+// are drawn, and the work depends on how many those are rather than on the
+// line's length. The Bresenham overloads produce exactly the unclipped
+// pixels: the visible part is found along the major axis in the integer step
+// domain (Liang-Barsky on the pixel index), and the decision term is computed
+// in closed form at the first visible pixel, in 128-bit arithmetic so any int
+// endpoints work. The DDA overloads draw lines that lie inside clip with
+// DDA_line() itself; lines that cross it round each position exactly instead
+// of accumulating float increments, so pixels whose position is a half pixel
+// (or within float drift of one) may round the other way than in DDA_line().
+void bresenham(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+               int y2);
+void bresenhamSpans(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+                    int y2);
+void DDA_line(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+              int y2);
+void DDA_lineSpans(PixelSink &sink, const Rect &clip, int x1, int y1, int x2,
+                   int y2);
+
+// Floating point DDA from the line-graph lab (end point excluded).
+void drawLineDDA(PixelSink &sink, float start_x, float start_y, float end_x,
+                 float end_y);
+
+// Plot (x, y) mirrored into all eight octants / four quadrants around the
+// center.
+void draw8SymmetricPoints(PixelSink &sink, int x_center, int y_center, int x,
+                          int y);
+void draw4SymmetricPoints(PixelSink &sink, int x_center, int y_center, int x,
+                          int y);
+
+void midPointCircle(PixelSink &sink, int x_center, int y_center, int radius);
+// Same pixels restricted to clip. Circles outside clip are rejected by their
+// bounding box; otherwise each octant's visible range of the walk is found
+// by binary search over the closed-form outline, and the walk starts there.
+void midPointCircle(PixelSink &sink, const Rect &clip, int x_center,
+                    int y_center, int radius);
+
+// Largest radius the ellipse functions draw; ellipses with a larger (or a
+// negative) radius draw nothing. The walk's per-step terms grow as 8 r^3 and
+// stay in int64 up to here.
+const int kMaxEllipseRadius = 1 << 19;
+
+// Midpoint ellipse with an all-integer decision parameter. Straight runs of
+// the outline are drawn as spans.
+void midPointEllipse(PixelSink &sink, int x_center, int y_center, int rx,
+                     int ry);
+// Same pixels restricted to clip. Ellipses outside clip are rejected by their
+// bounding box; otherwise each quadrant's visible range of both regions of
+// the walk is found by binary search over the closed-form outline, and the
+// walk resumes there, so the cost follows the visible pixels.
+void midPointEllipse(PixelSink &sink, const Rect &clip, int x_center,
+                     int y_center, int rx, int ry);
+void polarCoordinateCircle(PixelSink &sink, int x_center, int y_center,
+                           int radius);
+
+// Filled versions of the midpoint circle and ellipse: every row from the
+// leftmost to the rightmost outline pixel, emitted as one span per row, so a
+// Framebuffer fills each run with its SIMD writer. Decisions stay in
+// integers; the ellipse shares midPointEllipse()'s walk.
+void fillCircle(PixelSink &sink, int x_center, int y_center, int radius);
+void fillEllipse(PixelSink &sink, int x_center, int y_center, int rx, int ry);
+// Same pixels restricted to clip. Only the visible rows are visited, each
+// row's width coming from the walk's closed form, so a huge shape crossing a
+// small window costs that window's rows.
+void fillCircle(PixelSink &sink, const Rect &clip, int x_center, int y_center,
+                int radius);
+void fillEllipse(PixelSink &sink, const Rect &clip, int x_center,
+                 int y_center, int rx, int ry);
+
+// Filled triangle with pixel-center sampling and the top-left fill rule, so
+// triangles sharing an edge never both cover a pixel. Vertices are snapped to
+// 1/256 pixel and the edge functions are evaluated in integers, one span per
+// row. Either winding is accepted.
+void fillTriangle(PixelSink &sink, float x0, float y0, float x1, float y1,
+                  float x2, float y2);
+
+// Same, restricted to the pixels inside clip. Only the rows and columns of
+// clip are visited, which keeps per-tile rasterization of large triangles
+// cheap.
+void fillTriangle(PixelSink &sink, const Rect &clip, float x0, float y0,
+                  float x1, float y1, float x2, float y2);
+
+// Convex polygon drawn as a triangle fan around its first vertex.
+void fillConvexPolygon(PixelSink &sink, const float *x, const float *y,
+                       size_t count);
+// Same, visiting only the rows and columns of clip.
+void fillConvexPolygon(PixelSink &sink, const Rect &clip, const float *x,
+                       const float *y, size_t count);
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "framebuffer.h"
+#include "raster.h"
+#include "rect.h"
+
+// Compile-time specialized versions of bresenham(), midPointCircle() and
+// midPointEllipse(). Instead of plotting coordinates through a virtual
+// PixelSink, the kernels move cursors whose step directions are template
+// arguments: the octant (or quadrant) is picked once per primitive, and each
+// inner loop is a store, a fixed pointer step and a conditional one, with no
+// branches on slope or direction. They draw the same pixels as the functions
+// they mirror.
+//
+// A kernel sink provides
+//   Cursor at(int x, int y)    cursor with write(), move<DX, DY>() and
+//                              moveIf<DX, DY>(bool), steps in y-up pixels
+//   Rect bounds()              pixels the cursors may touch
+//   void plot(int x, int y)    single pixel, dropped outside bounds()
+//   void count(size_t n)       pixels written, for the profiler
+// Primitives not inside bounds() fall back to the clipped functions in
+// raster.h.
+
+// Pixel formats: the stored type and how a Color maps to it.
+struct RGBA8 {
+  using Pixel = uint32_t;
+  static Pixel fromColor(Color color) { return color.packed(); }
+};
+
+// Coverage masks: only alpha is kept.
+struct A8 {
+  using Pixel = uint8_t;
+  static Pixel fromColor(Color color) { return color.a; }
+};
+
+// Palette indices, set with SurfaceSink::setPixel().
+struct Index8 {
+  using Pixel = uint8_t;
+};
+
+// Kernel sink over a block of pixels: height rows of stride pixels, in the
+// centered, y-up coordinates of Framebuffer.
+template <typename Format> class SurfaceSink {
+public:
+  using Pixel = typename Format::Pixel;
+
+  class Cursor {
+  public:
+    Cursor(Pixel *p, ptrdiff_t stride, Pixel value)
+        : p_(p), stride_(stride), value_(value) {}
+
+    void write() { *p_ = value_; }
+    // Rows grow downwards while y grows upwards.
+    template <int DX, int DY> void move() { p_ += DX - DY * stride_; }
+    template <int DX, int DY> void moveIf(bool step) {
+      p_ += (DX - DY * stride_) & -ptrdiff_t(step);
+    }
+
+  private:
+    Pixel *p_;
+    ptrdiff_t stride_;
+    Pixel value_;
+  };
+
+  SurfaceSink(Pixel *pixels, int width, int height, ptrdiff_t stride)
+      : pixels_(pixels), width_(width), height_(height), stride_(stride) {}
+
+  void setColor(Color color) { value_ = Format::fromColor(color); }
+  void setPixel(Pixel value) { value_ = value; }
+
+  Rect bounds() const { return centeredRect(width_, height_); }
+  Cursor at(int x, int y) const {
+    return Cursor(pixels_ + ptrdiff_t(height_ / 2 - 1 - y) * stride_ +
+                      (x + width_ / 2),
+                  stride_, value_);
+  }
+  void plot(int x, int y) {
+    if (bounds().contains(x, y)) {
+      at(x, y).write();
+    }
+  }
+  void count([[maybe_unused]] size_t pixels) {
+    CG_PROFILE_COUNT(Pixels, pixels);
+  }
+
+private:
+  Pixel *pixels_;
+  int width_, height_;
+  ptrdiff_t stride_;
+  Pixel value_ = Pixel();
+};
+
+// The framebuffer's pixels as a kernel sink.
+inline SurfaceSink<RGBA8> surfaceOf(Framebuffer &framebuffer) {
+  return SurfaceSink<RGBA8>(framebuffer.row(0), framebuffer.width(),
+                            framebuffer.height(), framebuffer.stride());
+}
+
+// Kernel sink over anything with plot(x, y), such as a PixelSink or the GL
+// point sinks. Cursors step coordinates; nothing is clipped.
+template <typename Target> class PlotSink {
+public:
+  class Cursor {
+  public:
+    Cursor(Target *target, int x, int y) : target_(target), x_(x), y_(y) {}
+
+    void write() { target_->plot(x_, y_); }
+    template <int DX, int DY> void move() {
+      x_ += DX;
+      y_ += DY;
+    }
+    template <int DX, int DY> void moveIf(bool step) {
+      x_ += DX & -int(step);
+      y_ += DY & -int(step);
+    }
+
+  private:
+    Target *target_;
+    int x_, y_;
+  };
+
+  explicit PlotSink(Target &target) : target_(target) {}
+
+  Rect bounds() const { return {INT_MIN, INT_MIN, INT_MAX, INT_MAX}; }
+  Cursor at(int x, int y) { return Cursor(&target_, x, y); }
+  void plot(int x, int y) { target_.plot(x, y); }
+  void count(size_t) {}
+
+private:
+  Target &target_;
+};
+
+// PixelSink over a kernel sink, for the clipped fallbacks. The kernel sink
+// keeps its own color.
+template <typename Sink> class KernelPixelSink : public PixelSink {
+public:
+  explicit KernelPixelSink(Sink &sink) : sink_(sink) {}
+
+  void setColor(Color) override {}
+  void plot(int x, int y) override { sink_.plot(x, y); }
+
+private:
+  Sink &sink_;
+};
+
+// Whether the box lies inside clip, in 64 bits so far-away shapes compare
+// correctly.
+inline bool boxInside(const Rect &clip, int64_t xmin, int64_t ymin,
+                      int64_t xmax, int64_t ymax) {
+  return xmin >= clip.xmin && xmax <= clip.xmax && ymin >= clip.ymin &&
+         ymax <= clip.ymax;
+}
+
+// One octant of bresenham(): the major axis steps every pixel and the minor
+// axis when the decision term is non-negative.
+template <bool XMajor, int SX, int SY, typename Cursor>
+void bresenhamOctant(Cursor c, int major, int minor) {
+  int pk = 2 * minor - major;
+  for (int i = 0; i < major; ++i) {
+    c.write();
+    bool step = pk >= 0;
+    c.template moveIf<XMajor ? 0 : SX, XMajor ? SY : 0>(step);
+    pk += 2 * minor - (2 * major & -int(step));
+    c.template move<XMajor ? SX : 0, XMajor ? 0 : SY>();
+  }
+  c.write();
+}
+
+// Same pixels as bresenham(sink, x1, y1, x2, y2), clipped to sink.bounds().
+template <typename Sink>
+void bresenhamKernel(Sink &sink, int x1, int y1, int x2, int y2) {
+  Rect clip = sink.bounds();
+  if (!boxInside(clip, std::min(x1, x2), std::min(y1, y2), std::max(x1, x2),
+                 std::max(y1, y2))) {
+    KernelPixelSink<Sink> fallback(sink);
+    bresenham(fallback, clip, x1, y1, x2, y2);
+    return;
+  }
+  int dx = std::abs(x2 - x1), dy = std::abs(y2 - y1);
+  auto c = sink.at(x1, y1);
+  switch ((dx > dy) << 2 | (x1 < x2) << 1 | (y1 < y2)) {
+  case 0:
+    bresenhamOctant<false, -1, -1>(c, dy, dx);
+    break;
+  case 1:
+    bresenhamOctant<false, -1, 1>(c, dy, dx);
+    break;
+  case 2:
+    bresenhamOctant<false, 1, -1>(c, dy, dx);
+    break;
+  case 3:
+    bresenhamOctant<false, 1, 1>(c, dy, dx);
+    break;
+  case 4:
+    bresenhamOctant<true, -1, -1>(c, dx, dy);
+    break;
+  case 5:
+    bresenhamOctant<true, -1, 1>(c, dx, dy);
+    break;
+  case 6:
+    bresenhamOctant<true, 1, -1>(c, dx, dy);
+    break;
+  default:
+    bresenhamOctant<true, 1, 1>(c, dx, dy);
+    break;
+  }
+  sink.count(size_t(std::max(dx, dy)) + 1);
+}
+
+// Advance one octant of midPointCircle(), which plots (x, y) or, with Swap,
+// (y, x) with the signs (SU, SV): x grows every step and y falls on down.
+template <int SU, int SV, bool Swap, typename Cursor>
+void circleOctantStep(Cursor &c, bool down) {
+  if (Swap) {
+    c.template move<0, SV>();
+    c.template moveIf<-SU, 0>(down);
+  } else {
+    c.template move<SU, 0>();
+    c.template moveIf<0, -SV>(down);
+  }
+}
+
+// Same pixels as midPointCircle(sink, x_center, y_center, radius), clipped
+// to sink.bounds(). The eight octants are cursors that follow one walk.
+template <typename Sink>
+void midPointCircleKernel(Sink &sink, int x_center, int y_center,
+                          int radius) {
+  Rect clip = sink.bounds();
+  int64_t xc = x_center, yc = y_center, r = radius;
+  if (radius < 0 || !boxInside(clip, xc - r, yc - r, xc + r, yc + r)) {
+    KernelPixelSink<Sink> fallback(sink);
+    midPointCircle(fallback, clip, x_center, y_center, radius);
+    return;
+  }
+  decltype(sink.at(0, 0)) c[8] = {sink.at(x_center, y_center + radius),
+                                   sink.at(x_center, y_center + radius),
+                                   sink.at(x_center, y_center - radius),
+                                   sink.at(x_center, y_center - radius),
+                                   sink.at(x_center + radius, y_center),
+                                   sink.at(x_center - radius, y_center),
+                                   sink.at(x_center + radius, y_center),
+                                   sink.at(x_center - radius, y_center)};
+  int x = 0, y = radius;
+  int pk = 1 - radius;
+  for (;;) {
+    for (auto &octant : c) {
+      octant.write();
+    }
+    if (x >= y) {
+      break;
+    }
+    bool down = pk >= 0;
+    x = x + 1;
+    y -= down;
+    pk += 2 * x + 1 - (2 * y & -int(down));
+    circleOctantStep<1, 1, false>(c[0], down);
+    circleOctantStep<-1, 1, false>(c[1], down);
+    circleOctantStep<1, -1, false>(c[2], down);
+    circleOctantStep<-1, -1, false>(c[3], down);
+    circleOctantStep<1, 1, true>(c[4], down);
+    circleOctantStep<-1, 1, true>(c[5], down);
+    circleOctantStep<1, -1, true>(c[6], down);
+    circleOctantStep<-1, -1, true>(c[7], down);
+  }
+  sink.count(8 * (size_t(x) + 1));
+}
+
+// Advance the quadrant (SX, SY) of midPointEllipse() by one point: a step
+// along x, then along y if stepY (region 1), or the other way round (region
+// 2).
+template <int SX, int SY, bool Region1, typename Cursor>
+void ellipseQuadrantStep(Cursor &c, bool step) {
+  if (Region1) {
+    c.template move<SX, 0>();
+    c.template moveIf<0, -SY>(step);
+  } else {
+    c.template move<0, -SY>();
+    c.template moveIf<SX, 0>(step);
+  }
+}
+
+template <bool Region1, typename Cursor>
+void ellipseQuadrantsStep(Cursor (&c)[4], bool step) {
+  ellipseQuadrantStep<1, 1, Region1>(c[0], step);
+  ellipseQuadrantStep<-1, 1, Region1>(c[1], step);
+  ellipseQuadrantStep<1, -1, Region1>(c[2], step);
+  ellipseQuadrantStep<-1, -1, Region1>(c[3], step);
+  for (Cursor &quadrant : c) {
+    quadrant.write();
+  }
+}
+
+// Same pixels as midPointEllipse(sink, x_center, y_center, rx, ry), clipped
+// to sink.bounds(). The decision terms are walkEllipse()'s, updated with
+// masks instead of branches.
+template <typename Sink>
+void midPointEllipseKernel(Sink &sink, int x_center, int y_center, int rx,
+                           int ry) {
+  if (rx < 0 || ry < 0 || rx > kMaxEllipseRadius || ry > kMaxEllipseRadius) {
+    return;
+  }
+  Rect clip = sink.bounds();
+  int64_t xc = x_center, yc = y_center;
+  if (!boxInside(clip, xc - rx, yc - ry, xc + rx, yc + ry)) {
+    KernelPixelSink<Sink> fallback(sink);
+    midPointEllipse(fallback, clip, x_center, y_center, rx, ry);
+    return;
+  }
+  decltype(sink.at(0, 0)) c[4] = {
+      sink.at(x_center, y_center + ry), sink.at(x_center, y_center + ry),
+      sink.at(x_center, y_center - ry), sink.at(x_center, y_center - ry)};
+  for (auto &quadrant : c) {
+    quadrant.write();
+  }
+
+  const int64_t a2 = int64_t(rx) * rx, b2 = int64_t(ry) * ry;
+  const int64_t stepDx = 8 * b2, stepDy = 8 * a2;
+  int64_t x = 0, y = ry;
+  int64_t dx = 0, dy = stepDy * y;
+  int64_t pk = 4 * b2 - 4 * a2 * ry + a2;
+  size_t points = 1;
+
+  // Region 1: x steps every time, y when pk >= 0.
+  while (dx < dy) {
+    bool down = pk >= 0;
+    x++;
+    dx += stepDx;
+    y -= down;
+    dy -= stepDy & -int64_t(down);
+    pk += dx + 4 * b2 - (dy & -int64_t(down));
+    ellipseQuadrantsStep<true>(c, down);
+    ++points;
+  }
+
+  // Region 2: y steps every time, x when pk <= 0. Its starting terms need
+  // 128 bits, the sum stays within a few steps.
+  using int128 = __int128;
+  pk = int64_t(b2 * int128(2 * x + 1) * (2 * x + 1) +
+               4 * a2 * int128(y - 1) * (y - 1) - 4 * int128(a2) * b2);
+  while (y > 0) {
+    bool right = pk <= 0;
+    y--;
+    dy -= stepDy;
+    x += right;
+    dx += stepDx & -int64_t(right);
+    pk += 4 * a2 - dy + (dx & -int64_t(right));
+    ellipseQuadrantsStep<false>(c, right);
+    ++points;
+  }
+  sink.count(4 * points);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+
+// Inclusive integer rectangle in the centered, y-up pixel coordinates used by
+// PixelSink.
+struct Rect {
+  int xmin, ymin, xmax, ymax;
+
+  bool empty() const { return xmin > xmax || ymin > ymax; }
+  bool contains(int x, int y) const {
+    return x >= xmin && x <= xmax && y >= ymin && y <= ymax;
+  }
+  bool intersects(const Rect &o) const {
+    return xmin <= o.xmax && o.xmin <= xmax && ymin <= o.ymax &&
+           o.ymin <= ymax;
+  }
+  Rect intersect(const Rect &o) const {
+    return {std::max(xmin, o.xmin), std::max(ymin, o.ymin),
+            std::min(xmax, o.xmax), std::min(ymax, o.ymax)};
+  }
+  Rect unite(const Rect &o) const {
+    return {std::min(xmin, o.xmin), std::min(ymin, o.ymin),
+            std::max(xmax, o.xmax), std::max(ymax, o.ymax)};
+  }
+};
+
+// Pixels visible in a width x height viewport set up with
+// glOrtho(-width / 2, width / 2, -height / 2, height / 2), which is also what
+// a Framebuffer of that size covers.
+inline Rect centeredRect(int width, int height) {
+  return {-(width / 2), height / 2 - height, width - width / 2 - 1,
+          height / 2 - 1};
+}
@@ -0,0 +1,128 @@
+#include "scene.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tessellate.h"
+
+bool Shape::update(float pixelsPerUnit) {
+  if (!dirty_) {
+    return false;
+  }
+  pixelsPerUnit_ = pixelsPerUnit;
+  mesh_.clear();
+  points_.clear();
+  build(mesh_, points_);
+  dirty_ = false;
+  return true;
+}
+
+void RectShape::setRect(float x, float y, float width, float height) {
+  x_ = x;
+  y_ = y;
+  width_ = width;
+  height_ = height;
+  markDirty();
+}
+
+void RectShape::build(Mesh &mesh, PointBatch &) const {
+  tessellateRect(mesh, color(), x_, y_, width_, height_);
+}
+
+void PolygonShape::setVertices(std::vector<Vertex> vertices) {
+  vertices_ = std::move(vertices);
+  markDirty();
+}
+
+void PolygonShape::build(Mesh &mesh, PointBatch &) const {
+  mesh.begin(mode_, color());
+  for (const Vertex &v : vertices_) {
+    mesh.vertex(v[0], v[1]);
+  }
+}
+
+void CircleShape::setRadius(float radius) {
+  radius_ = radius;
+  markDirty();
+}
+
+void CircleShape::setLod(LodPolicy lod) {
+  lod_ = lod;
+  markDirty();
+}
+
+void CircleShape::build(Mesh &mesh, PointBatch &) const {
+  tessellateCircle(mesh, color(), radius_,
+                   lod_.resolve(radius_, 2.0f * M_PI, pixelsPerUnit()));
+}
+
+void ArcShape::setAngles(float startAngle, float endAngle) {
+  startAngle_ = startAngle;
+  endAngle_ = endAngle;
+  markDirty();
+}
+
+void ArcShape::setLod(LodPolicy lod) {
+  lod_ = lod;
+  markDirty();
+}
+
+void ArcShape::build(Mesh &mesh, PointBatch &) const {
+  int segments =
+      lod_.resolve(radius_, endAngle_ - startAngle_, pixelsPerUnit());
+  tessellateArc(mesh, color(), radius_, startAngle_, endAngle_, segments,
+                lineWidth_);
+}
+
+void FilledArcShape::setRadii(float outerRadius, float innerRadius) {
+  outerRadius_ = outerRadius;
+  innerRadius_ = innerRadius;
+  markDirty();
+}
+
+void FilledArcShape::setAngles(float startAngle, float endAngle) {
+  startAngle_ = startAngle;
+  endAngle_ = endAngle;
+  markDirty();
+}
+
+void FilledArcShape::setLod(LodPolicy lod) {
+  lod_ = lod;
+  markDirty();
+}
+
+void FilledArcShape::build(Mesh &mesh, PointBatch &) const {
+  // The outer edge has the larger chord error.
+  float radius = std::max(std::fabs(outerRadius_), std::fabs(innerRadius_));
+  int segments = lod_.resolve(radius, endAngle_ - startAngle_, pixelsPerUnit());
+  tessellateFilledArc(mesh, color(), outerRadius_, innerRadius_, startAngle_,
+                      endAngle_, segments);
+}
+
+void RasterShape::build(Mesh &, PointBatch &points) const {
+  points.setColor(color());
+  draw_(points);
+}
+
+void Scene::setPixelsPerUnit(float pixelsPerUnit) {
+  if (pixelsPerUnit == pixelsPerUnit_) {
+    return;
+  }
+  pixelsPerUnit_ = pixelsPerUnit;
+  for (auto &shape : shapes_) {
+    if (shape->dependsOnScale()) {
+      shape->markDirty();
+    }
+  }
+}
+
+bool Scene::update() {
+  bool changed = false;
+  for (auto &shape : shapes_) {
+    changed |= shape->update(pixelsPerUnit_);
+  }
+  if (changed) {
+    ++version_;
+  }
+  return changed;
+}
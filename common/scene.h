@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mesh.h"
+#include "point_batch.h"
+#include "tessellate.h"
+
+// A retained primitive. Its geometry is generated once into a cached mesh
+// and/or point batch and only regenerated after a parameter setter marked it
+// dirty.
+class Shape {
+public:
+  virtual ~Shape() = default;
+
+  Color color() const { return color_; }
+  void setColor(Color color) {
+    color_ = color;
+    markDirty();
+  }
+
+  bool dirty() const { return dirty_; }
+  void markDirty() { dirty_ = true; }
+
+  // Rebuild the cached geometry if needed. Returns true if it was rebuilt.
+  bool update(float pixelsPerUnit = 1.0f);
+
+  // Shapes whose geometry depends on the projection scale (adaptive level of
+  // detail) are rebuilt when the scene's scale changes.
+  virtual bool dependsOnScale() const { return false; }
+
+  const Mesh &mesh() const { return mesh_; }
+  const PointBatch &points() const { return points_; }
+
+protected:
+  virtual void build(Mesh &mesh, PointBatch &points) const = 0;
+
+  // Screen pixels per scene unit for the build in progress.
+  float pixelsPerUnit() const { return pixelsPerUnit_; }
+
+private:
+  Color color_;
+  bool dirty_ = true;
+  float pixelsPerUnit_ = 1.0f;
+  Mesh mesh_;
+  PointBatch points_;
+};
+
+class RectShape : public Shape {
+public:
+  RectShape(float x, float y, float width, float height)
+      : x_(x), y_(y), width_(width), height_(height) {}
+
+  void setRect(float x, float y, float width, float height);
+
+protected:
+  void build(Mesh &mesh, PointBatch &points) const override;
+
+private:
+  float x_, y_, width_, height_;
+};
+
+// Arbitrary vertex list drawn as GL_QUADS or GL_POLYGON.
+class PolygonShape : public Shape {
+public:
+  using Vertex = std::array<float, 2>;
+
+  PolygonShape(std::vector<Vertex> vertices,
+               PrimitiveMode mode = PrimitiveMode::Polygon)
+      : vertices_(std::move(vertices)), mode_(mode) {}
+
+  void setVertices(std::vector<Vertex> vertices);
+
+protected:
+  void build(Mesh &mesh, PointBatch &points) const override;
+
+private:
+  std::vector<Vertex> vertices_;
+  PrimitiveMode mode_;
+};
+
+class CircleShape : public Shape {
+public:
+  CircleShape(float radius, LodPolicy lod) : radius_(radius), lod_(lod) {}
+
+  void setRadius(float radius);
+  void setLod(LodPolicy lod);
+  bool dependsOnScale() const override { return lod_.isAdaptive(); }
+
+protected:
+  void build(Mesh &mesh, PointBatch &points) const override;
+
+private:
+  float radius_;
+  LodPolicy lod_;
+};
+
+class ArcShape : public Shape {
+public:
+  ArcShape(float radius, float startAngle, float endAngle, LodPolicy lod,
+           float lineWidth = 1.0f)
+      : radius_(radius), startAngle_(startAngle), endAngle_(endAngle),
+        lod_(lod), lineWidth_(lineWidth) {}
+
+  void setAngles(float startAngle, float endAngle);
+  void setLod(LodPolicy lod);
+  bool dependsOnScale() const override { return lod_.isAdaptive(); }
+
+protected:
+  void build(Mesh &mesh, PointBatch &points) const override;
+
+private:
+  float radius_, startAngle_, endAngle_;
+  LodPolicy lod_;
+  float lineWidth_;
+};
+
+class FilledArcShape : public Shape {
+public:
+  FilledArcShape(float outerRadius, float innerRadius, float startAngle,
+                 float endAngle, LodPolicy lod)
+      : outerRadius_(outerRadius), innerRadius_(innerRadius),
+        startAngle_(startAngle), endAngle_(endAngle), lod_(lod) {}
+
+  void setRadii(float outerRadius, float innerRadius);
+  void setAngles(float startAngle, float endAngle);
+  void setLod(LodPolicy lod);
+  bool dependsOnScale() const override { return lod_.isAdaptive(); }
+
+protected:
+  void build(Mesh &mesh, PointBatch &points) const override;
+
+private:
+  float outerRadius_, innerRadius_, startAngle_, endAngle_;
+  LodPolicy lod_;
+};
+
+// Pixels produced by one of the scan-conversion routines in raster.h. The
+// callback captures the parameters; call markDirty() after changing them.
+class RasterShape : public Shape {
+public:
+  explicit RasterShape(std::function<void(PixelSink &)> draw)
+      : draw_(std::move(draw)) {}
+
+protected:
+  void build(Mesh &mesh, PointBatch &points) const override;
+
+private:
+  std::function<void(PixelSink &)> draw_;
+};
+
+// Owns the shapes of a static or mostly static picture. update() regenerates
+// only dirty shapes; version() changes whenever any cached geometry does, so
+// backends can keep their own copy until it moves.
+class Scene {
+public:
+  template <typename T, typename... Args> T &add(Args &&...args) {
+    auto shape = std::make_unique<T>(std::forward<Args>(args)...);
+    T &ref = *shape;
+    shapes_.push_back(std::move(shape));
+    ++version_;
+    return ref;
+  }
+
+  // Returns true if any shape was rebuilt.
+  bool update();
+
+  // Projection scale used for level-of-detail decisions. For
+  // glOrtho(left, right, ...) on a viewport w pixels wide this is
+  // w / (right - left); the labs' pixel-for-unit setup gives 1.
+  void setPixelsPerUnit(float pixelsPerUnit);
+  float pixelsPerUnit() const { return pixelsPerUnit_; }
+
+  uint64_t version() const { return version_; }
+  const std::vector<std::unique_ptr<Shape>> &shapes() const { return shapes_; }
+
+private:
+  std::vector<std::unique_ptr<Shape>> shapes_;
+  uint64_t version_ = 0;
+  float pixelsPerUnit_ = 1.0f;
+};
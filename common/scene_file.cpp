@@ -0,0 +1,339 @@
+#include "scene_file.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "antialias.h"
+#include "raster.h"
+#include "raster_kernels.h"
+#include "transform.h"
+
+namespace {
+
+const float kPi = 3.14159265f;
+
+bool toFloat(const std::string &word, float &value) {
+  char *end = nullptr;
+  value = std::strtof(word.c_str(), &end);
+  return end != word.c_str() && *end == '\0' && std::isfinite(value);
+}
+
+// Pixel coordinates far outside any framebuffer are clamped so they still
+// fit the integer rasterizers' arithmetic; clipping removes them anyway.
+int toPixel(float v) {
+  const float limit = float(1 << 30);
+  return int(std::lround(std::max(-limit, std::min(v, limit))));
+}
+
+// Whether the box around (x, y) with half sizes rx, ry overlaps clip. The
+// fills and arcs walk their whole height, so shapes off screen are skipped.
+bool touches(const Rect &clip, float x, float y, float rx, float ry) {
+  return x + rx >= clip.xmin && x - rx <= clip.xmax + 1 &&
+         y + ry >= clip.ymin && y - ry <= clip.ymax + 1;
+}
+
+// Whether op has the numbers its kind needs and they all lie in params.
+bool isValid(const SceneFile::Op &op, const float *params, size_t paramCount) {
+  if (op.first > paramCount || op.count > paramCount - op.first) {
+    return false;
+  }
+  size_t needed = 0;
+  switch (op.kind) {
+  case SceneFile::Kind::Line:
+  case SceneFile::Kind::Ellipse:
+    needed = 4;
+    break;
+  case SceneFile::Kind::Circle:
+    needed = 3;
+    break;
+  case SceneFile::Kind::Arc:
+    needed = 6;
+    break;
+  case SceneFile::Kind::Polygon:
+    if (op.count < 6 || op.count % 2 != 0) {
+      return false;
+    }
+    needed = op.count;
+    break;
+  default:
+    return false;
+  }
+  if (op.count < needed) {
+    return false;
+  }
+  for (size_t i = op.first; i < op.first + needed; ++i) {
+    if (!std::isfinite(params[i])) {
+      return false;
+    }
+  }
+  // The ellipse walk is only exact up to kMaxEllipseRadius.
+  const float *p = params + op.first;
+  if (op.kind == SceneFile::Kind::Ellipse &&
+      (toPixel(p[2]) > kMaxEllipseRadius ||
+       toPixel(p[3]) > kMaxEllipseRadius)) {
+    return false;
+  }
+  return true;
+}
+
+bool isColor(const std::vector<float> &numbers) {
+  for (float v : numbers) {
+    if (v < 0 || v > 255) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+bool parseScene(std::istream &in, const std::string &name, SceneFile &scene) {
+  TransformStack stack;
+  Color color(0, 0, 0);
+  int lineNumber = 0;
+  auto fail = [&](const std::string &message) {
+    std::cerr << name << ":" << lineNumber << ": " << message << std::endl;
+    return false;
+  };
+  auto add = [&](SceneFile::Kind kind, bool flag,
+                 std::initializer_list<float> params) {
+    scene.ops.push_back({kind, flag, color, uint32_t(scene.params.size()),
+                         uint32_t(params.size())});
+    scene.params.insert(scene.params.end(), params);
+  };
+
+  std::string text;
+  while (std::getline(in, text)) {
+    ++lineNumber;
+    text = text.substr(0, text.find('#'));
+    std::istringstream words(text);
+    std::string command;
+    if (!(words >> command)) {
+      continue;
+    }
+    if (command == "output") {
+      std::getline(words >> std::ws, scene.output);
+      while (!scene.output.empty() &&
+             std::isspace(static_cast<unsigned char>(scene.output.back()))) {
+        scene.output.pop_back();
+      }
+      if (scene.output.empty()) {
+        return fail("output needs a path");
+      }
+      continue;
+    }
+
+    // Numbers, plus at most one keyword (dda, bresenham or fill).
+    std::vector<float> n;
+    std::string keyword;
+    for (std::string word; words >> word;) {
+      float value;
+      if (toFloat(word, value)) {
+        n.push_back(value);
+      } else if (keyword.empty()) {
+        keyword = word;
+      } else {
+        return fail("unexpected '" + word + "'");
+      }
+    }
+    auto expect = [&](size_t minCount, size_t maxCount,
+                      std::initializer_list<const char *> keywords) {
+      if (n.size() < minCount || n.size() > maxCount) {
+        return false;
+      }
+      if (keyword.empty()) {
+        return true;
+      }
+      for (const char *allowed : keywords) {
+        if (keyword == allowed) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    const Transform2D &m = stack.top();
+    // How much the transform stretches each axis, and lengths overall.
+    float scaleX = std::hypot(m.a, m.c), scaleY = std::hypot(m.b, m.d);
+    float scale = std::sqrt(std::fabs(m.determinant()));
+
+    if (command == "size") {
+      if (!expect(2, 2, {}) || n[0] < 1 || n[1] < 1 || n[0] > 65536 ||
+          n[1] > 65536) {
+        return fail("size needs a width and a height between 1 and 65536");
+      }
+      scene.width = int(n[0]);
+      scene.height = int(n[1]);
+    } else if (command == "background" || command == "color") {
+      size_t channels = command == "color" ? 4 : 3;
+      if (!expect(3, channels, {}) || !isColor(n)) {
+        return fail(command + " needs R G B" +
+                    (channels == 4 ? " [A]" : "") + " from 0 to 255");
+      }
+      Color c{uint8_t(n[0]), uint8_t(n[1]), uint8_t(n[2]),
+              uint8_t(n.size() > 3 ? n[3] : 255)};
+      (command == "color" ? color : scene.background) = c;
+    } else if (command == "line") {
+      if (!expect(4, 4, {"dda", "bresenham"})) {
+        return fail("usage: line [dda|bresenham] X1 Y1 X2 Y2");
+      }
+      auto p1 = m.apply(n[0], n[1]), p2 = m.apply(n[2], n[3]);
+      add(SceneFile::Kind::Line, keyword == "dda",
+          {p1[0], p1[1], p2[0], p2[1]});
+    } else if (command == "circle") {
+      if (!expect(3, 3, {"fill"}) || n[2] < 0) {
+        return fail("usage: circle X Y R [fill]");
+      }
+      auto c = m.apply(n[0], n[1]);
+      if (std::fabs(scaleX - scaleY) <= 1e-4f * std::max(scaleX, scaleY)) {
+        add(SceneFile::Kind::Circle, keyword == "fill",
+            {c[0], c[1], n[2] * scale});
+      } else {
+        add(SceneFile::Kind::Ellipse, keyword == "fill",
+            {c[0], c[1], n[2] * scaleX, n[2] * scaleY});
+      }
+    } else if (command == "ellipse") {
+      if (!expect(4, 4, {"fill"}) || n[2] < 0 || n[3] < 0) {
+        return fail("usage: ellipse X Y RX RY [fill]");
+      }
+      auto c = m.apply(n[0], n[1]);
+      add(SceneFile::Kind::Ellipse, keyword == "fill",
+          {c[0], c[1], n[2] * scaleX, n[3] * scaleY});
+    } else if (command == "arc") {
+      if (!expect(5, 6, {}) || n[2] < 0) {
+        return fail("usage: arc X Y R START END [WIDTH]");
+      }
+      auto c = m.apply(n[0], n[1]);
+      float turn = std::atan2(m.c, m.a) * 180 / kPi;
+      float start = n[3], end = n[4];
+      if (m.determinant() < 0) {
+        // A mirror reverses the direction of the sweep.
+        std::swap(start, end);
+        start = -start;
+        end = -end;
+      }
+      float width = n.size() > 5 ? n[5] : 1.0f;
+      add(SceneFile::Kind::Arc, false,
+          {c[0], c[1], n[2] * scale, start + turn, end + turn, width * scale});
+    } else if (command == "polygon") {
+      if (!expect(6, size_t(-1), {}) || n.size() % 2 != 0) {
+        return fail("usage: polygon X1 Y1 X2 Y2 X3 Y3 ...");
+      }
+      // Stored as all x then all y, as fillConvexPolygon() takes them.
+      size_t count = n.size() / 2;
+      scene.ops.push_back({SceneFile::Kind::Polygon, false, color,
+                           uint32_t(scene.params.size()), uint32_t(n.size())});
+      size_t first = scene.params.size();
+      scene.params.resize(first + n.size());
+      for (size_t i = 0; i < count; ++i) {
+        auto p = m.apply(n[2 * i], n[2 * i + 1]);
+        scene.params[first + i] = p[0];
+        scene.params[first + count + i] = p[1];
+      }
+    } else if (command == "push" || command == "pop" ||
+               command == "identity") {
+      if (!expect(0, 0, {})) {
+        return fail(command + " takes no arguments");
+      }
+      if (command == "push") {
+        stack.push();
+      } else if (command == "pop") {
+        stack.pop();
+      } else {
+        stack.loadIdentity();
+      }
+    } else if (command == "translate") {
+      if (!expect(2, 2, {})) {
+        return fail("usage: translate TX TY");
+      }
+      stack.translate(n[0], n[1]);
+    } else if (command == "rotate") {
+      if (!expect(1, 1, {})) {
+        return fail("usage: rotate DEGREES");
+      }
+      stack.rotate(n[0]);
+    } else if (command == "scale") {
+      if (!expect(1, 2, {})) {
+        return fail("usage: scale SX [SY]");
+      }
+      stack.scale(n[0], n.size() > 1 ? n[1] : n[0]);
+    } else {
+      return fail("unknown command '" + command + "'");
+    }
+  }
+  return true;
+}
+
+bool loadScene(const std::string &path, SceneFile &scene) {
+  std::ifstream in(path);
+  if (!in) {
+    std::cerr << "Failed to open " << path << std::endl;
+    return false;
+  }
+  return parseScene(in, path, scene);
+}
+
+void renderScene(const SceneView &scene, Framebuffer &framebuffer) {
+  framebuffer.clear(scene.background);
+  Rect clip = framebuffer.bounds();
+  // Outlines go through the specialized kernels, straight into the pixels.
+  SurfaceSink<RGBA8> surface = surfaceOf(framebuffer);
+  for (size_t i = 0; i < scene.opCount; ++i) {
+    const SceneFile::Op &op = scene.ops[i];
+    if (!isValid(op, scene.params, scene.paramCount)) {
+      continue;
+    }
+    const float *p = scene.params + op.first;
+    framebuffer.setColor(op.color);
+    surface.setColor(op.color);
+    switch (op.kind) {
+    case SceneFile::Kind::Line:
+      if (op.flag) {
+        DDA_lineSpans(framebuffer, clip, toPixel(p[0]), toPixel(p[1]),
+                      toPixel(p[2]), toPixel(p[3]));
+      } else {
+        bresenhamSpans(framebuffer, clip, toPixel(p[0]), toPixel(p[1]),
+                       toPixel(p[2]), toPixel(p[3]));
+      }
+      break;
+    case SceneFile::Kind::Circle:
+      if (!touches(clip, p[0], p[1], p[2], p[2])) {
+        break;
+      }
+      if (op.flag) {
+        fillCircle(framebuffer, clip, toPixel(p[0]), toPixel(p[1]),
+                   toPixel(p[2]));
+      } else {
+        midPointCircleKernel(surface, toPixel(p[0]), toPixel(p[1]),
+                             toPixel(p[2]));
+      }
+      break;
+    case SceneFile::Kind::Ellipse:
+      if (!touches(clip, p[0], p[1], p[2], p[3])) {
+        break;
+      }
+      if (op.flag) {
+        fillEllipse(framebuffer, clip, toPixel(p[0]), toPixel(p[1]),
+                    toPixel(p[2]), toPixel(p[3]));
+      } else {
+        midPointEllipseKernel(surface, toPixel(p[0]), toPixel(p[1]),
+                              toPixel(p[2]), toPixel(p[3]));
+      }
+      break;
+    case SceneFile::Kind::Arc:
+      if (!touches(clip, p[0], p[1], p[2] + p[5], p[2] + p[5])) {
+        break;
+      }
+      strokeArc(framebuffer, p[0], p[1], p[2], p[3] * kPi / 180,
+                p[4] * kPi / 180, p[5]);
+      break;
+    case SceneFile::Kind::Polygon:
+      fillConvexPolygon(framebuffer, clip, p, p + op.count / 2, op.count / 2);
+      break;
+    }
+  }
+}
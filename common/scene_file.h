@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "framebuffer.h"
+#include "pixel_sink.h"
+
+// Text description of a picture for headless batch rendering. One command per
+// line, '#' starts a comment, coordinates are centered and y-up like the
+// labs:
+//
+//   size W H                     framebuffer size (default 1920 1080)
+//   background R G B             clear color (default white)
+//   output PATH                  where the batch renderer saves the image
+//   color R G B [A]              color for the following shapes
+//   line [dda|bresenham] X1 Y1 X2 Y2
+//   circle X Y R [fill]          midpoint circle
+//   ellipse X Y RX RY [fill]     midpoint ellipse
+//   arc X Y R START END [WIDTH]  anti-aliased stroke, angles in degrees
+//   polygon X1 Y1 X2 Y2 X3 Y3... filled convex polygon
+//   push | pop | identity        transform stack, as in lab4
+//   translate TX TY | rotate DEG | scale SX [SY]
+//
+// Transforms are applied while parsing. Lines and polygons take any affine
+// transform; circles, ellipses and arcs move their center and scale their
+// radii, and arcs also turn with the rotation, but ellipses stay axis-aligned.
+struct SceneView;
+
+struct SceneFile {
+  // Stored as is in geometry files (geometry_file.h): only append kinds.
+  enum class Kind : uint8_t { Line, Circle, Ellipse, Arc, Polygon };
+
+  // One draw command; its numbers are params[first, first + count).
+  struct Op {
+    Kind kind;
+    // Nonzero for DDA lines and for filled circles and ellipses.
+    uint8_t flag;
+    Color color;
+    uint32_t first, count;
+  };
+
+  int width = 1920, height = 1080;
+  Color background = Color(255, 255, 255);
+  std::string output;
+  std::vector<Op> ops;
+  std::vector<float> params;
+
+  SceneView view() const;
+};
+
+// A scene's commands without owning them, so they can come from a SceneFile or
+// straight from a mapped geometry file.
+struct SceneView {
+  int width = 1920, height = 1080;
+  Color background = Color(255, 255, 255);
+  const SceneFile::Op *ops = nullptr;
+  size_t opCount = 0;
+  const float *params = nullptr;
+  size_t paramCount = 0;
+};
+
+inline SceneView SceneFile::view() const {
+  return {width,      height,        background,   ops.data(),
+          ops.size(), params.data(), params.size()};
+}
+
+// Parse a scene. Errors are reported as "name:line: message" and make the
+// functions return false.
+bool parseScene(std::istream &in, const std::string &name, SceneFile &scene);
+bool loadScene(const std::string &path, SceneFile &scene);
+
+// Clear the framebuffer to the scene's background and draw every command,
+// clipped to the framebuffer. Commands whose numbers are missing, out of
+// range or not finite are skipped, so views of untrusted files are safe.
+void renderScene(const SceneView &scene, Framebuffer &framebuffer);
+inline void renderScene(const SceneFile &scene, Framebuffer &framebuffer) {
+  renderScene(scene.view(), framebuffer);
+}
@@ -0,0 +1,125 @@
+#include "stream_chart.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mapped_file.h"
+#include "raster.h"
+
+StreamingChart::StreamingChart(double xStart, double xStep, size_t capacity)
+    : xStart_(xStart), xStep_(xStep), capacity_(std::max<size_t>(capacity, 1)) {
+  ring_.reserve(capacity_);
+}
+
+void StreamingChart::push(int value) {
+  int x = int(std::floor(xStart_ + double(samples_) * xStep_));
+  ++samples_;
+  if (hasCurrent_ && x == current_.x) {
+    current_.last = value;
+    current_.min = std::min(current_.min, value);
+    current_.max = std::max(current_.max, value);
+    return;
+  }
+  closeColumn();
+  current_ = {x, value, value, value, value};
+  hasCurrent_ = true;
+}
+
+void StreamingChart::push(const int *values, size_t count) {
+  while (count > 0) {
+    if (!hasCurrent_ || xStep_ <= 0) {
+      push(*values++);
+      --count;
+      continue;
+    }
+
+    // Index of the first sample past the current column, computed once per
+    // column and corrected for rounding so it agrees with push(int).
+    auto columnOf = [this](uint64_t i) {
+      return int(std::floor(xStart_ + double(i) * xStep_));
+    };
+    double boundary = std::ceil((current_.x + 1 - xStart_) / xStep_);
+    uint64_t next =
+        std::max<uint64_t>(samples_, uint64_t(std::max(boundary, 0.0)));
+    while (next > samples_ && columnOf(next - 1) != current_.x) {
+      --next;
+    }
+    while (columnOf(next) == current_.x) {
+      ++next;
+    }
+
+    size_t n = size_t(std::min<uint64_t>(next - samples_, count));
+    if (n == 0) {
+      push(*values++);
+      --count;
+      continue;
+    }
+    int lo = current_.min, hi = current_.max;
+    for (size_t i = 0; i < n; ++i) {
+      lo = std::min(lo, values[i]);
+      hi = std::max(hi, values[i]);
+    }
+    current_.min = lo;
+    current_.max = hi;
+    current_.last = values[n - 1];
+    samples_ += n;
+    values += n;
+    count -= n;
+  }
+}
+
+bool StreamingChart::pushFile(const std::string &path) {
+  MappedFile file;
+  if (!file.open(path)) {
+    return false;
+  }
+  const unsigned char *data = file.data();
+  size_t count = file.size() / sizeof(int32_t);
+  // mmap returns page-aligned memory, so the samples can be read in place.
+  static_assert(sizeof(int32_t) == sizeof(int), "int32 samples");
+  push(reinterpret_cast<const int *>(data), count);
+  return true;
+}
+
+void StreamingChart::flush() { closeColumn(); }
+
+void StreamingChart::closeColumn() {
+  if (!hasCurrent_) {
+    return;
+  }
+  if (ring_.size() < capacity_) {
+    ring_.push_back(current_);
+  } else {
+    ring_[columns_ % capacity_] = current_;
+  }
+  ++columns_;
+  hasCurrent_ = false;
+}
+
+void StreamingChart::drawColumn(PixelSink &sink, uint64_t sequence,
+                                int xOffset) const {
+  const Column &c = column(sequence);
+  int x = c.x + xOffset;
+  uint64_t oldest = columns_ - ring_.size();
+  if (sequence > oldest) {
+    const Column &p = column(sequence - 1);
+    bresenhamSpans(sink, p.x + xOffset, p.last, x, c.first);
+  }
+  sink.vspan(x, c.min, c.max);
+}
+
+size_t StreamingChart::drawNew(PixelSink &sink, int xOffset) {
+  uint64_t oldest = columns_ - ring_.size();
+  uint64_t from = std::max(drawn_, oldest);
+  for (uint64_t s = from; s < columns_; ++s) {
+    drawColumn(sink, s, xOffset);
+  }
+  drawn_ = columns_;
+  return size_t(columns_ - from);
+}
+
+void StreamingChart::drawAll(PixelSink &sink, int xOffset) const {
+  for (uint64_t s = columns_ - ring_.size(); s < columns_; ++s) {
+    drawColumn(sink, s, xOffset);
+  }
+}
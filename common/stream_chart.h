@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pixel_sink.h"
+
+// Line graph for series that are too long to keep or to draw segment by
+// segment. Sample i sits at x = xStart + i * xStep. Samples that land in the
+// same pixel column are reduced to that column's first, last, min and max
+// value (M4 decimation), so drawing cost depends on the number of columns,
+// not on the number of samples. Only the most recent `capacity` columns are
+// kept.
+//
+// When every sample gets its own column the output is the same as drawing a
+// Bresenham segment between consecutive samples.
+class StreamingChart {
+public:
+  StreamingChart(double xStart, double xStep, size_t capacity);
+
+  void push(int value);
+  void push(const int *values, size_t count);
+  // Stream a file of raw little-endian int32 samples through a memory map.
+  bool pushFile(const std::string &path);
+
+  // Close the column that is still collecting samples so it can be drawn.
+  void flush();
+
+  // Draw the columns completed since the previous drawNew() call. Returns
+  // the number of columns drawn.
+  size_t drawNew(PixelSink &sink, int xOffset = 0);
+  // Draw every retained column, e.g. after the target was cleared.
+  void drawAll(PixelSink &sink, int xOffset = 0) const;
+
+  uint64_t sampleCount() const { return samples_; }
+  uint64_t columnCount() const { return columns_; }
+  size_t retainedColumns() const { return ring_.size(); }
+
+private:
+  struct Column {
+    int x;
+    int first, last, min, max;
+  };
+
+  void closeColumn();
+  const Column &column(uint64_t sequence) const {
+    return ring_[sequence % capacity_];
+  }
+  // Draw column `sequence`, joined to the previous column if still retained.
+  void drawColumn(PixelSink &sink, uint64_t sequence, int xOffset) const;
+
+  double xStart_, xStep_;
+  size_t capacity_;
+  std::vector<Column> ring_;
+  uint64_t columns_ = 0;   // columns closed so far
+  uint64_t drawn_ = 0;     // columns handed to drawNew() so far
+  uint64_t samples_ = 0;
+  Column current_{};
+  bool hasCurrent_ = false;
+};
@@ -0,0 +1,96 @@
+#include "tessellate.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+const std::vector<float> &unitCircle(int segments) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::unique_ptr<std::vector<float>>> tables;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &table = tables[segments];
+  if (!table) {
+    table = std::make_unique<std::vector<float>>();
+    table->reserve(size_t(std::max(segments, 0) + 1) * 2);
+    for (int i = 0; i <= segments; ++i) {
+      double theta = 2.0 * M_PI * i / segments;
+      table->push_back(i == segments ? 1.0f : float(std::cos(theta)));
+      table->push_back(i == segments ? 0.0f : float(std::sin(theta)));
+    }
+  }
+  return *table;
+}
+
+int segmentsForArc(float radius, float sweep, float pixelsPerUnit,
+                   float maxPixelError) {
+  const int maxSegments = 4096;
+  double r = std::fabs(double(radius) * pixelsPerUnit);
+  double angle = std::fabs(double(sweep));
+  if (angle == 0 || r == 0) {
+    return 1;
+  }
+  double tolerance = std::max(double(maxPixelError), 1e-3);
+  // Widest step whose sagitta stays within tolerance; a half turn when the
+  // whole radius is below it.
+  double step = tolerance >= r ? M_PI : 2.0 * std::acos(1.0 - tolerance / r);
+  int segments = int(std::ceil(angle / step));
+  // A closed circle needs at least a triangle.
+  int minSegments = angle >= 2.0 * M_PI - 1e-6 ? 3 : 1;
+  return std::min(std::max(segments, minSegments), maxSegments);
+}
+
+void tessellateCircle(Mesh &mesh, Color color, float radius, int segments) {
+  mesh.begin(PrimitiveMode::TriangleFan, color);
+  mesh.vertex(0, 0); // Center of the circle
+  if (segments <= 0) {
+    return;
+  }
+  const std::vector<float> &unit = unitCircle(segments);
+  for (int i = 0; i <= segments; ++i) {
+    mesh.vertex(radius * unit[i * 2], radius * unit[i * 2 + 1]);
+  }
+}
+
+void tessellateRect(Mesh &mesh, Color color, float x, float y, float width,
+                    float height) {
+  mesh.begin(PrimitiveMode::Quads, color);
+  mesh.vertex(x - width / 2, y - height / 2);
+  mesh.vertex(x + width / 2, y - height / 2);
+  mesh.vertex(x + width / 2, y + height / 2);
+  mesh.vertex(x - width / 2, y + height / 2);
+}
+
+void tessellateArc(Mesh &mesh, Color color, float radius, float startAngle,
+                   float endAngle, int segments, float lineWidth) {
+  mesh.begin(PrimitiveMode::LineStrip, color, lineWidth);
+  if (segments <= 0) {
+    return;
+  }
+  ArcGenerator arc(startAngle, double(endAngle - startAngle) / segments);
+  for (int i = 0; i <= segments; ++i, arc.next()) {
+    mesh.vertex(radius * arc.cos(), radius * arc.sin());
+  }
+}
+
+void tessellateFilledArc(Mesh &mesh, Color color, float outerRadius,
+                         float innerRadius, float startAngle, float endAngle,
+                         int segments) {
+  mesh.begin(PrimitiveMode::TriangleStrip, color);
+  if (segments <= 0) {
+    return;
+  }
+  // Step the angle from startAngle to endAngle; both radii share each
+  // angle's cos/sin.
+  ArcGenerator arc(startAngle, double(endAngle - startAngle) / segments);
+  for (int i = 0; i <= segments; ++i, arc.next()) {
+    float c = arc.cos(), s = arc.sin();
+
+    // Outer arc point (larger radius)
+    mesh.vertex(outerRadius * c, outerRadius * s);
+
+    // Inner arc point (smaller radius)
+    mesh.vertex(innerRadius * c, innerRadius * s);
+  }
+}
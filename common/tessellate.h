@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "mesh.h"
+
+// Unit circle sampled at segments + 1 evenly spaced angles starting at 0:
+// cos/sin interleaved, last point equal to the first. Tables are computed once
+// per segment count and shared (thread-safe); the reference stays valid for
+// the life of the program.
+const std::vector<float> &unitCircle(int segments);
+
+// Points along an arc by repeated rotation: one cos/sin pair for the start
+// angle and one for the step, then four multiply-adds per point. Runs in
+// double so 10^5 steps stay well below float precision.
+class ArcGenerator {
+public:
+  ArcGenerator(double startAngle, double stepAngle)
+      : c_(std::cos(startAngle)), s_(std::sin(startAngle)),
+        stepC_(std::cos(stepAngle)), stepS_(std::sin(stepAngle)) {}
+
+  float cos() const { return float(c_); }
+  float sin() const { return float(s_); }
+
+  void next() {
+    double c = c_ * stepC_ - s_ * stepS_;
+    s_ = s_ * stepC_ + c_ * stepS_;
+    c_ = c;
+  }
+
+private:
+  double c_, s_, stepC_, stepS_;
+};
+
+// Fewest segments for which the chords of an arc with this radius and sweep
+// (radians) stray at most maxPixelError pixels from the true curve once
+// scaled by pixelsPerUnit. The chord sagitta is r * (1 - cos(step / 2)).
+int segmentsForArc(float radius, float sweep, float pixelsPerUnit,
+                   float maxPixelError);
+
+// Level-of-detail policy for curved primitives: a fixed segment count (the
+// labs' original behaviour, implicit from int) or a segment count chosen from
+// the on-screen size and an error tolerance in pixels.
+struct LodPolicy {
+  int segments = 0;            // > 0: fixed count
+  float maxPixelError = 0.25f; // used when segments == 0
+
+  LodPolicy(int fixedSegments) : segments(fixedSegments) {}
+  static LodPolicy adaptive(float maxPixelError = 0.25f) {
+    LodPolicy lod(0);
+    lod.maxPixelError = maxPixelError;
+    return lod;
+  }
+
+  bool isAdaptive() const { return segments <= 0; }
+  int resolve(float radius, float sweep, float pixelsPerUnit) const {
+    return isAdaptive()
+               ? segmentsForArc(radius, sweep, pixelsPerUnit, maxPixelError)
+               : segments;
+  }
+};
+
+// Geometry generators for the filled shapes of the logo lab. Each call
+// appends one run to the mesh.
+
+// Triangle fan around the origin.
+void tessellateCircle(Mesh &mesh, Color color, float radius, int segments);
+// Axis-aligned rectangle centered on (x, y).
+void tessellateRect(Mesh &mesh, Color color, float x, float y, float width,
+                    float height);
+// Line strip along a circle of the given radius, angles in radians.
+void tessellateArc(Mesh &mesh, Color color, float radius, float startAngle,
+                   float endAngle, int segments, float lineWidth);
+// Triangle strip filling the ring between two radii.
+void tessellateFilledArc(Mesh &mesh, Color color, float outerRadius,
+                         float innerRadius, float startAngle, float endAngle,
+                         int segments);
@@ -0,0 +1,112 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads) {
+  unsigned workers = threads > 1 ? threads - 1 : 0;
+  for (unsigned i = 0; i <= workers; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (unsigned i = 0; i < workers; ++i) {
+    workers_.emplace_back([this, i] { workerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::push(size_t queue, std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+    queues_[queue]->tasks.push_back(std::move(task));
+  }
+  queued_.fetch_add(1);
+  {
+    // Taking the lock orders the increment before a sleeper's re-check.
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::runOne(size_t self) {
+  std::function<void()> task;
+  {
+    Queue &own = *queues_[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+  for (size_t i = 1; !task && i < queues_.size(); ++i) {
+    Queue &victim = *queues_[(self + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  queued_.fetch_sub(1);
+  task();
+  return true;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+  while (true) {
+    if (runOne(index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+    if (stop_ && queued_.load() == 0) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::parallelFor(size_t count,
+                             const std::function<void(size_t)> &fn,
+                             size_t grain) {
+  if (count == 0) {
+    return;
+  }
+  if (workers_.empty() || count <= grain) {
+    for (size_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  // A few chunks per thread so stealing can even out uneven work.
+  size_t chunk = std::max(grain, count / (size_t(size()) * 4));
+  size_t chunks = (count + chunk - 1) / chunk;
+  std::atomic<size_t> remaining{chunks};
+  for (size_t c = 0; c < chunks; ++c) {
+    size_t begin = c * chunk, end = std::min(count, begin + chunk);
+    push(c % queues_.size(), [&fn, &remaining, begin, end] {
+      for (size_t i = begin; i < end; ++i) {
+        fn(i);
+      }
+      remaining.fetch_sub(1);
+    });
+  }
+
+  // Help until every chunk of this job has run.
+  size_t self = queues_.size() - 1;
+  while (remaining.load() > 0) {
+    if (!runOne(self)) {
+      std::this_thread::yield();
+    }
+  }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a task deque; it pops its own
+// newest task and, when empty, steals the oldest task of another worker. The
+// thread that calls parallelFor() works on the job too until it completes.
+class ThreadPool {
+public:
+  // threads is the total parallelism including the calling thread.
+  explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  unsigned size() const { return unsigned(workers_.size()) + 1; }
+
+  // Run fn(i) for every i in [0, count) and return once all calls finished.
+  // Indices are handed out in chunks of at least grain.
+  void parallelFor(size_t count, const std::function<void(size_t)> &fn,
+                   size_t grain = 1);
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void push(size_t queue, std::function<void()> task);
+  bool runOne(size_t self);
+  void workerLoop(size_t index);
+
+  // One queue per worker plus a shared one for outside callers (last).
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> queued_{0};
+  std::mutex sleepMutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+};
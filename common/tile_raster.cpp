@@ -0,0 +1,143 @@
+#include "tile_raster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "profiler.h"
+#include "raster.h"
+
+void appendMeshTriangles(std::vector<Triangle> &out, const Mesh &mesh,
+                         const Transform2D &view) {
+  for (const Mesh::Run &run : mesh.runs) {
+    const float *v = mesh.vertices.data() + size_t(run.first) * 2;
+    auto add = [&](uint32_t i, uint32_t j, uint32_t k) {
+      auto p0 = view.apply(v[i * 2], v[i * 2 + 1]);
+      auto p1 = view.apply(v[j * 2], v[j * 2 + 1]);
+      auto p2 = view.apply(v[k * 2], v[k * 2 + 1]);
+      out.push_back({p0[0], p0[1], p1[0], p1[1], p2[0], p2[1], run.color});
+    };
+    switch (run.mode) {
+    case PrimitiveMode::Triangles:
+      for (uint32_t i = 0; i + 2 < run.count; i += 3) {
+        add(i, i + 1, i + 2);
+      }
+      break;
+    case PrimitiveMode::TriangleStrip:
+      for (uint32_t i = 0; i + 2 < run.count; ++i) {
+        add(i, i + 1, i + 2);
+      }
+      break;
+    case PrimitiveMode::TriangleFan:
+    case PrimitiveMode::Polygon:
+      for (uint32_t i = 1; i + 1 < run.count; ++i) {
+        add(0, i, i + 1);
+      }
+      break;
+    case PrimitiveMode::Quads:
+      for (uint32_t i = 0; i + 3 < run.count; i += 4) {
+        add(i, i + 1, i + 2);
+        add(i, i + 2, i + 3);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void rasterizeTriangles(Framebuffer &framebuffer, const Triangle *triangles,
+                        size_t count, ThreadPool &pool, int tileSize) {
+  rasterizeTriangles(framebuffer, framebuffer.bounds(), triangles, count, pool,
+                     tileSize);
+}
+
+void rasterizeTriangles(Framebuffer &framebuffer, const Rect &clip,
+                        const Triangle *triangles, size_t count,
+                        ThreadPool &pool, int tileSize) {
+  CG_PROFILE_SCOPE("rasterizeTriangles");
+  Rect area = clip.intersect(framebuffer.bounds());
+  if (count == 0 || area.empty()) {
+    return;
+  }
+  tileSize = std::max(tileSize, 8);
+  // Tiles are counted from the top-left corner of area; tile column c and
+  // row r start at x = area.xmin + c * tileSize, y = area.ymax - r * tileSize.
+  int areaWidth = area.xmax - area.xmin + 1;
+  int areaHeight = area.ymax - area.ymin + 1;
+  int tilesX = (areaWidth + tileSize - 1) / tileSize;
+  int tilesY = (areaHeight + tileSize - 1) / tileSize;
+
+  // Bin triangle indices per tile from their bounding boxes; chunks are
+  // binned in parallel and kept apart to preserve input order.
+  const size_t chunkSize = 4096;
+  size_t chunks = (count + chunkSize - 1) / chunkSize;
+  std::vector<std::vector<std::vector<uint32_t>>> bins(
+      chunks, std::vector<std::vector<uint32_t>>(size_t(tilesX) * tilesY));
+  pool.parallelFor(chunks, [&](size_t c) {
+    size_t end = std::min(count, (c + 1) * chunkSize);
+    for (size_t i = c * chunkSize; i < end; ++i) {
+      const Triangle &t = triangles[i];
+      float minX = std::min({t.x0, t.x1, t.x2});
+      float maxX = std::max({t.x0, t.x1, t.x2});
+      float minY = std::min({t.y0, t.y1, t.y2});
+      float maxY = std::max({t.y0, t.y1, t.y2});
+      Rect box = {int(std::floor(minX)), int(std::floor(minY)),
+                  int(std::ceil(maxX)), int(std::ceil(maxY))};
+      box = box.intersect(area);
+      if (box.empty()) {
+        continue;
+      }
+      int firstTileX = (box.xmin - area.xmin) / tileSize;
+      int lastTileX = (box.xmax - area.xmin) / tileSize;
+      // Higher y is a lower row.
+      int firstTileY = (area.ymax - box.ymax) / tileSize;
+      int lastTileY = (area.ymax - box.ymin) / tileSize;
+      for (int ty = firstTileY; ty <= lastTileY; ++ty) {
+        for (int tx = firstTileX; tx <= lastTileX; ++tx) {
+          bins[c][size_t(ty) * tilesX + tx].push_back(uint32_t(i));
+        }
+      }
+    }
+  });
+
+  pool.parallelFor(size_t(tilesX) * tilesY, [&](size_t tile) {
+    CG_PROFILE_SCOPE("rasterizeTriangles tile");
+    int firstCol = int(tile % tilesX) * tileSize;
+    int firstRow = int(tile / tilesX) * tileSize;
+    int lastCol = std::min(firstCol + tileSize, areaWidth) - 1;
+    int lastRow = std::min(firstRow + tileSize, areaHeight) - 1;
+    Rect tileClip = {area.xmin + firstCol, area.ymax - lastRow,
+                     area.xmin + lastCol, area.ymax - firstRow};
+    FramebufferRegion region(framebuffer, tileClip);
+    for (size_t c = 0; c < chunks; ++c) {
+      for (uint32_t i : bins[c][tile]) {
+        const Triangle &t = triangles[i];
+        region.setColor(t.color);
+        fillTriangle(region, tileClip, t.x0, t.y0, t.x1, t.y1, t.x2, t.y2);
+      }
+    }
+  });
+}
+
+void rasterizeScene(Framebuffer &framebuffer, Scene &scene, ThreadPool &pool,
+                    const Transform2D &view, int tileSize) {
+  CG_PROFILE_SCOPE("rasterizeScene");
+  scene.update();
+  std::vector<Triangle> triangles;
+  for (const auto &shape : scene.shapes()) {
+    appendMeshTriangles(triangles, shape->mesh(), view);
+  }
+  rasterizeTriangles(framebuffer, triangles, pool, tileSize);
+
+  for (const auto &shape : scene.shapes()) {
+    const PointBatch &points = shape->points();
+    for (size_t r = 0; r < points.runs().size(); ++r) {
+      framebuffer.setColor(points.runs()[r].color);
+      const PackedPoint *p = points.points().data() + points.runs()[r].first;
+      for (size_t i = 0; i < points.runSize(r); ++i) {
+        framebuffer.plot(p[i].x, p[i].y);
+      }
+    }
+  }
+}
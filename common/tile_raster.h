@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "framebuffer.h"
+#include "mesh.h"
+#include "scene.h"
+#include "thread_pool.h"
+#include "transform.h"
+
+struct Triangle {
+  float x0, y0, x1, y1, x2, y2;
+  Color color;
+};
+
+// Append the filled runs of a mesh (triangles, strips, fans, quads and
+// polygons) as triangles in draw order, with view applied to the vertices.
+// Point and line runs are skipped.
+void appendMeshTriangles(std::vector<Triangle> &out, const Mesh &mesh,
+                         const Transform2D &view = Transform2D());
+
+// Fill many triangles into a framebuffer on a thread pool.
+//
+// The framebuffer is split into tileSize x tileSize tiles and each triangle
+// is binned into the tiles its bounding box touches. Every tile is owned by
+// one task, which fills its triangles in input order with fillTriangle()
+// restricted to the tile, so the result does not depend on the thread count
+// and shared edges follow the top-left rule across tiles too.
+void rasterizeTriangles(Framebuffer &framebuffer, const Triangle *triangles,
+                        size_t count, ThreadPool &pool, int tileSize = 64);
+
+inline void rasterizeTriangles(Framebuffer &framebuffer,
+                               const std::vector<Triangle> &triangles,
+                               ThreadPool &pool, int tileSize = 64) {
+  rasterizeTriangles(framebuffer, triangles.data(), triangles.size(), pool,
+                     tileSize);
+}
+
+// Same, touching only the pixels inside clip: the tiles cover clip rather
+// than the whole framebuffer, so redrawing a small dirty area is cheap. The
+// pixels inside clip are the same as with a full redraw.
+void rasterizeTriangles(Framebuffer &framebuffer, const Rect &clip,
+                        const Triangle *triangles, size_t count,
+                        ThreadPool &pool, int tileSize = 64);
+
+// Software counterpart of GLSceneCache::draw(): rebuilds dirty shapes and
+// fills every shape's mesh through rasterizeTriangles() with view applied.
+// Point batches are drawn afterwards, untransformed.
+void rasterizeScene(Framebuffer &framebuffer, Scene &scene, ThreadPool &pool,
+                    const Transform2D &view = Transform2D(),
+                    int tileSize = 64);
@@ -0,0 +1,57 @@
+#include "transform.h"
+
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+Transform2D Transform2D::rotation(float degrees) {
+  float rad = degrees * M_PI / 180;
+  float cs = cos(rad), sn = sin(rad);
+  return {cs, -sn, 0, sn, cs, 0};
+}
+
+PointBuffer::PointBuffer(std::initializer_list<std::array<float, 2>> points) {
+  reserve(points.size());
+  for (const auto &p : points) {
+    push_back(p[0], p[1]);
+  }
+}
+
+void applyTransform(const Transform2D &m, const float *xIn, const float *yIn,
+                    float *xOut, float *yOut, size_t count) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  __m256 a = _mm256_set1_ps(m.a), b = _mm256_set1_ps(m.b);
+  __m256 c = _mm256_set1_ps(m.c), d = _mm256_set1_ps(m.d);
+  __m256 tx = _mm256_set1_ps(m.tx), ty = _mm256_set1_ps(m.ty);
+  for (; i + 8 <= count; i += 8) {
+    __m256 x = _mm256_loadu_ps(xIn + i);
+    __m256 y = _mm256_loadu_ps(yIn + i);
+    __m256 nx = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(a, x), _mm256_mul_ps(b, y)), tx);
+    __m256 ny = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(c, x), _mm256_mul_ps(d, y)), ty);
+    _mm256_storeu_ps(xOut + i, nx);
+    _mm256_storeu_ps(yOut + i, ny);
+  }
+#elif defined(__SSE2__)
+  __m128 a = _mm_set1_ps(m.a), b = _mm_set1_ps(m.b);
+  __m128 c = _mm_set1_ps(m.c), d = _mm_set1_ps(m.d);
+  __m128 tx = _mm_set1_ps(m.tx), ty = _mm_set1_ps(m.ty);
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(xIn + i);
+    __m128 y = _mm_loadu_ps(yIn + i);
+    __m128 nx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), tx);
+    __m128 ny = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c, x), _mm_mul_ps(d, y)), ty);
+    _mm_storeu_ps(xOut + i, nx);
+    _mm_storeu_ps(yOut + i, ny);
+  }
+#endif
+  for (; i < count; ++i) {
+    float x = xIn[i], y = yIn[i];
+    xOut[i] = m.a * x + m.b * y + m.tx;
+    yOut[i] = m.c * x + m.d * y + m.ty;
+  }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+#include "aligned.h"
+
+// 2D affine transform stored as the top two rows of the homogeneous 3x3
+// matrix (the bottom row is always 0 0 1):
+//   x' = a * x + b * y + tx
+//   y' = c * x + d * y + ty
+struct Transform2D {
+  float a = 1, b = 0, tx = 0;
+  float c = 0, d = 1, ty = 0;
+
+  static constexpr Transform2D translation(float tx, float ty) {
+    return {1, 0, tx, 0, 1, ty};
+  }
+  static constexpr Transform2D scaling(float sx, float sy) {
+    return {sx, 0, 0, 0, sy, 0};
+  }
+  // Counter-clockwise rotation about the origin, angle in degrees.
+  static Transform2D rotation(float degrees);
+
+  // Composition: (m * n) applied to a point equals m applied to n's result,
+  // i.e. n runs first, as with glMultMatrix.
+  constexpr Transform2D operator*(const Transform2D &n) const {
+    return {a * n.a + b * n.c, a * n.b + b * n.d, a * n.tx + b * n.ty + tx,
+            c * n.a + d * n.c, c * n.b + d * n.d, c * n.tx + d * n.ty + ty};
+  }
+  constexpr Transform2D &operator*=(const Transform2D &n) {
+    return *this = *this * n;
+  }
+
+  constexpr float determinant() const { return a * d - b * c; }
+
+  // Inverse of an invertible transform (determinant() != 0).
+  constexpr Transform2D inverse() const {
+    float inv = 1.0f / determinant();
+    float ia = d * inv, ib = -b * inv, ic = -c * inv, id = a * inv;
+    return {ia, ib, -(ia * tx + ib * ty), ic, id, -(ic * tx + id * ty)};
+  }
+
+  constexpr std::array<float, 2> apply(float x, float y) const {
+    return {a * x + b * y + tx, c * x + d * y + ty};
+  }
+};
+
+// glPushMatrix/glPopMatrix style stack of composed transforms. Operations
+// post-multiply the top, so the last one issued is applied to the geometry
+// first. Objects are drawn with a single applyTransform(top()) pass however
+// many operations built it.
+class TransformStack {
+public:
+  TransformStack() : stack_(1) {}
+
+  const Transform2D &top() const { return stack_.back(); }
+
+  void push() { stack_.push_back(stack_.back()); }
+  // Popping the last entry resets it to identity instead.
+  void pop() {
+    if (stack_.size() > 1) {
+      stack_.pop_back();
+    } else {
+      stack_.back() = Transform2D();
+    }
+  }
+  size_t depth() const { return stack_.size(); }
+
+  void loadIdentity() { stack_.back() = Transform2D(); }
+  void multiply(const Transform2D &m) { stack_.back() *= m; }
+  void translate(float tx, float ty) {
+    multiply(Transform2D::translation(tx, ty));
+  }
+  void scale(float sx, float sy) { multiply(Transform2D::scaling(sx, sy)); }
+  void rotate(float degrees) { multiply(Transform2D::rotation(degrees)); }
+
+private:
+  std::vector<Transform2D> stack_;
+};
+
+// Structure-of-arrays point list: x and y live in separate cache-line aligned
+// float arrays so transforms can stream over them with SIMD.
+class PointBuffer {
+public:
+  PointBuffer() = default;
+  PointBuffer(std::initializer_list<std::array<float, 2>> points);
+
+  size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+  void resize(size_t n) {
+    x_.resize(n);
+    y_.resize(n);
+  }
+  void reserve(size_t n) {
+    x_.reserve(n);
+    y_.reserve(n);
+  }
+  void clear() {
+    x_.clear();
+    y_.clear();
+  }
+  void push_back(float x, float y) {
+    x_.push_back(x);
+    y_.push_back(y);
+  }
+
+  float *x() { return x_.data(); }
+  float *y() { return y_.data(); }
+  const float *x() const { return x_.data(); }
+  const float *y() const { return y_.data(); }
+
+private:
+  std::vector<float, AlignedAllocator<float>> x_, y_;
+};
+
+// out = m * in for count points. The input and output arrays may be the same
+// (in-place) but must not otherwise overlap. Uses AVX2 (8 points per step) or
+// SSE2 (4 points) when compiled for it.
+void applyTransform(const Transform2D &m, const float *xIn, const float *yIn,
+                    float *xOut, float *yOut, size_t count);
+
+inline void applyTransform(const Transform2D &m, PointBuffer &points) {
+  applyTransform(m, points.x(), points.y(), points.x(), points.y(),
+                 points.size());
+}
+
+inline void applyTransform(const Transform2D &m, const PointBuffer &in,
+                           PointBuffer &out) {
+  out.resize(in.size());
+  applyTransform(m, in.x(), in.y(), out.x(), out.y(), in.size());
+}
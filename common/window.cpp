@@ -0,0 +1,64 @@
+#include "window.h"
+
+#include <iostream>
+#include <string>
+
+GLFWwindow *initializeGLFW(const char *title) {
+  if (!glfwInit()) {
+    std::cerr << "Failed to initialize GLFW" << std::endl;
+    return nullptr;
+  }
+
+  GLFWmonitor *primaryMonitor = glfwGetPrimaryMonitor();
+  if (!primaryMonitor) {
+    std::cerr << "Failed to get primary monitor" << std::endl;
+    glfwTerminate();
+    return nullptr;
+  }
+
+  const GLFWvidmode *videoMode = glfwGetVideoMode(primaryMonitor);
+  if (!videoMode) {
+    std::cerr << "Failed to get video mode of the primary monitor" << std::endl;
+    glfwTerminate();
+    return nullptr;
+  }
+
+  GLFWwindow *window = glfwCreateWindow(videoMode->width, videoMode->height,
+                                        title, NULL, NULL);
+  if (!window) {
+    glfwTerminate();
+    std::cerr << "Failed to create GLFW window" << std::endl;
+    return nullptr;
+  }
+
+  return window;
+}
+
+namespace {
+
+bool repaintPending = true;
+
+void onRefresh(GLFWwindow *) { repaintPending = true; }
+
+} // namespace
+
+bool waitForRepaint(GLFWwindow *window) {
+  glfwSetWindowRefreshCallback(window, onRefresh);
+  while (!repaintPending && !glfwWindowShouldClose(window)) {
+    glfwWaitEvents();
+  }
+  repaintPending = false;
+  return !glfwWindowShouldClose(window);
+}
+
+void showProfileOverlay(GLFWwindow *window, const char *title) {
+  static double lastUpdate = -1;
+  double now = glfwGetTime();
+  if (lastUpdate >= 0 && now - lastUpdate < 0.25) {
+    return;
+  }
+  lastUpdate = now;
+  std::string text =
+      std::string(title) + " | " + Profiler::instance().summary();
+  glfwSetWindowTitle(window, text.c_str());
+}
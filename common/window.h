@@ -0,0 +1,28 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include "profiler.h"
+
+// Initialize GLFW and open a window the size of the primary monitor's video
+// mode. Prints the reason and returns nullptr on failure (GLFW is terminated
+// again in that case).
+GLFWwindow *initializeGLFW(const char *title);
+
+// For pictures that do not change between frames: waits for events until the
+// window needs painting (the first call, then whenever the window system
+// reports its contents damaged, e.g. exposed or resized) and returns true, or
+// returns false once the window should close. The labs open one window each,
+// which this assumes.
+bool waitForRepaint(GLFWwindow *window);
+
+// Show the profiler's summary after title in the window title, refreshed a
+// few times a second. Use it through CG_PROFILE_OVERLAY so it compiles out
+// with the rest of the instrumentation.
+void showProfileOverlay(GLFWwindow *window, const char *title);
+
+#if defined(CG_ENABLE_PROFILING)
+#define CG_PROFILE_OVERLAY(window, title) showProfileOverlay(window, title)
+#else
+#define CG_PROFILE_OVERLAY(window, title) ((void)0)
+#endif
@@ -1,125 +1,112 @@
 #include <GL/gl.h>
 #include <GLFW/glfw3.h>
 #include <cmath>
-#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../common/antialias.h"
+#include "../common/framebuffer.h"
+#include "../common/gl_draw.h"
+#include "../common/raster.h"
+#include "../common/scene.h"
+#include "../common/thread_pool.h"
+#include "../common/tile_raster.h"
+#include "../common/window.h"
 
 #define PI 3.14159265
 
-GLFWwindow *initializeGLFW() {
-  if (!glfwInit()) {
-    std::cerr << "Failed to initialize GLFW" << std::endl;
-  }
-
-  GLFWmonitor *primaryMonitor = glfwGetPrimaryMonitor();
-  if (!primaryMonitor) {
-    std::cerr << "Failed to get primary monitor" << std::endl;
-    glfwTerminate();
-  }
-
-  const GLFWvidmode *videoMode = glfwGetVideoMode(primaryMonitor);
-  if (!videoMode) {
-    std::cerr << "Failed to get video mode of the primary monitor" << std::endl;
-    glfwTerminate();
-  }
-
-  std::cout << "Resolution: " << videoMode->width << "*" << videoMode->height
-            << std::endl;
+// Add the logo's primitives to the scene. They are tessellated once and
+// redrawn from the cache every frame.
+void buildLogo(Scene &scene) {
+  Color red(255, 0, 0); // Red color for the "N" shape and the arcs
 
-  GLFWwindow *window = glfwCreateWindow(videoMode->width, videoMode->height,
-                                        "Nepal Tourism Board Logo", NULL, NULL);
-  if (!window) {
-    glfwTerminate();
-    std::cerr << "Failed to create GLFW window" << std::endl;
-  }
-
-  return window;
-}
+  // Draw the vertical lines of "N"
+  scene.add<RectShape>(-60.0f, 0.0f, 50.0f, 200.0f).setColor(red);
+  scene.add<RectShape>(60.0f, 0.0f, 50.0f, 200.0f).setColor(red);
+  // Draw the horizontal line of "N"
+  scene.add<RectShape>(0.0f, 0.0f, 360.0f, 40.0f).setColor(red);
 
-void drawCircle(float radius, int segments) {
-  glBegin(GL_TRIANGLE_FAN);
-  glVertex2f(0, 0); // Center of the circle
-  for (int i = 0; i <= segments; ++i) {
-    float theta = 2.0f * PI * float(i) / float(segments);
-    float x = radius * cosf(theta);
-    float y = radius * sinf(theta);
-    glVertex2f(x, y);
-  }
-  glEnd();
+  // Draw the diagonal line of "N"
+  scene
+      .add<PolygonShape>(std::vector<PolygonShape::Vertex>{{-85.0f, 100.0f},
+                                                           {-35.0f, 100.0f},
+                                                           {85.0f, -100.0f},
+                                                           {35.0f, -100.0f}},
+                         PrimitiveMode::Quads)
+      .setColor(red);
+
+  // scene.add<ArcShape>(150.0f, PI / 6, PI, 500, 50.0f).setColor(red);
+  // scene.add<ArcShape>(150.0f, 7 * PI / 6, 2 * PI, 500, 50.0f).setColor(red);
+
+  // Draw the Arcs. The segment count follows the on-screen radius: about 25
+  // per arc at a quarter pixel of error instead of a fixed 500.
+  scene
+      .add<FilledArcShape>(180.0f, 150.0f, PI / 6, PI, LodPolicy::adaptive())
+      .setColor(red);
+  scene
+      .add<FilledArcShape>(180.0f, 150.0f, 7 * PI / 6, 2 * PI,
+                           LodPolicy::adaptive())
+      .setColor(red);
 }
 
-void drawRect(float x, float y, float width, float height) {
-  glBegin(GL_QUADS);
-  glVertex2f(x - width / 2, y - height / 2);
-  glVertex2f(x + width / 2, y - height / 2);
-  glVertex2f(x + width / 2, y + height / 2);
-  glVertex2f(x - width / 2, y + height / 2);
-  glEnd();
+// Anti-aliased software rendering of the same logo, scaled by scale. The
+// arcs are strokes (rings 150-180 like the filled arcs) instead of relying on
+// the driver's GL_LINE_SMOOTH support for wide lines.
+void renderLogo(PixelSink &sink, float scale) {
+  sink.setColor(Color(255, 0, 0));
+
+  auto polygon = [&](std::vector<float> xs, std::vector<float> ys) {
+    for (size_t i = 0; i < xs.size(); ++i) {
+      xs[i] *= scale;
+      ys[i] *= scale;
+    }
+    fillConvexPolygon(sink, xs.data(), ys.data(), xs.size());
+  };
+  auto rect = [&](float x, float y, float w, float h) {
+    polygon({x - w / 2, x + w / 2, x + w / 2, x - w / 2},
+            {y - h / 2, y - h / 2, y + h / 2, y + h / 2});
+  };
+  rect(-60.0f, 0.0f, 50.0f, 200.0f);
+  rect(60.0f, 0.0f, 50.0f, 200.0f);
+  rect(0.0f, 0.0f, 360.0f, 40.0f);
+  polygon({-85.0f, -35.0f, 85.0f, 35.0f}, {100.0f, 100.0f, -100.0f, -100.0f});
+
+  strokeArc(sink, 0.0f, 0.0f, 165.0f * scale, PI / 6, PI, 30.0f * scale);
+  strokeArc(sink, 0.0f, 0.0f, 165.0f * scale, 7 * PI / 6, 2 * PI,
+            30.0f * scale);
 }
 
-void drawArc(float radius, float startAngle, float endAngle, int segments) {
-  glLineWidth(50.0f);       // Set the line width
-  glEnable(GL_LINE_SMOOTH); // Enable anti-aliasing for smoother lines
-  glHint(GL_LINE_SMOOTH_HINT, GL_NICEST); // Set the quality of anti-aliasing
-
-  glBegin(GL_LINE_STRIP);
-  for (int i = 0; i <= segments; ++i) {
-    float angle = startAngle + (endAngle - startAngle) * i / segments;
-    float x = radius * cos(angle);
-    float y = radius * sin(angle);
-    glVertex2f(x, y); // Set the vertex of the arc
+int main(int argc, char **argv) {
+  // Headless mode: ./firstOpenGlApp out.png [width height [aa]]. The logo
+  // keeps its size relative to a 1080-line screen. By default the scene's
+  // meshes go through the tiled triangle rasterizer; "aa" draws it with the
+  // anti-aliased rasterizers instead.
+  if (argc > 1) {
+    int width = argc > 3 ? atoi(argv[2]) : 1920;
+    int height = argc > 3 ? atoi(argv[3]) : 1080;
+    float scale = height / 1080.0f;
+    Framebuffer framebuffer(width, height);
+    CG_PROFILE_FRAME();
+    if (argc > 4 && std::string(argv[4]) == "aa") {
+      renderLogo(framebuffer, scale);
+    } else {
+      Scene scene;
+      buildLogo(scene);
+      scene.setPixelsPerUnit(scale);
+      ThreadPool pool;
+      rasterizeScene(framebuffer, scene, pool,
+                     Transform2D::scaling(scale, scale));
+    }
+    CG_PROFILE_FRAME();
+    CG_PROFILE_FINISH();
+    return framebuffer.save(argv[1]) ? 0 : -1;
   }
-  glEnd();
-}
 
-void drawFilledArc(float outerRadius, float innerRadius, float startAngle,
-                   float endAngle, int segments) {
-  glBegin(GL_TRIANGLE_STRIP); // Use triangle strip to fill between inner and
-                              // outer arcs
-  for (int i = 0; i <= segments; ++i) {
-    // Interpolate the angle from startAngle to endAngle
-    float angle = startAngle + (endAngle - startAngle) * i / segments;
-
-    // Outer arc point (larger radius)
-    float outerX = outerRadius * cosf(angle);
-    float outerY = outerRadius * sinf(angle);
-    glVertex2f(outerX, outerY);
-
-    // Inner arc point (smaller radius)
-    float innerX = innerRadius * cosf(angle);
-    float innerY = innerRadius * sinf(angle);
-    glVertex2f(innerX, innerY);
+  GLFWwindow *window = initializeGLFW("Nepal Tourism Board Logo");
+  if (!window) {
+    return -1;
   }
-  glEnd();
-}
-
-void drawLogo() {
-  glColor3f(1.0f, 0.0f, 0.0f); // Red color
-  glColor3f(1.0f, 0.0f, 0.0f); // White for the "N" shape
-
-  drawRect(-60.0f, 0.0f, 50.0f, 200.0f); // Draw the vertical line of "N"
-  drawRect(60.0f, 0.0f, 50.0f, 200.0f);  // Draw the vertical line of "N"
-  drawRect(0.0f, 0.0f, 360.0f, 40.0f);   // Draw the horizontal line of "N"
-
-  // Draw the diagonal line of "N"
-  // drawDiagonal(-60.0f, 0.0f, 40.0f, 200.0f);
-  glColor3f(1.0f, 0.0f, 0.0f);
-  glBegin(GL_QUADS);
-  glVertex2f(-85.0f, 100.0f);
-  glVertex2f(-35.0f, 100.0f);
-  glVertex2f(85.0f, -100.0f);
-  glVertex2f(35.0f, -100.0f);
-  glEnd();
-
-  // drawArc(150.0f, PI / 6, PI, 500);
-  // drawArc(150.0f, 7 * PI / 6, 2 * PI, 500);
-
-  // Draw the Arcs
-  drawFilledArc(180.0f, 150.0f, PI / 6, PI, 500);
-  drawFilledArc(180.0f, 150.0f, 7 * PI / 6, 2 * PI, 500);
-}
-
-int main() {
-  GLFWwindow *window = initializeGLFW();
   glfwMakeContextCurrent(window);
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
@@ -132,15 +119,31 @@ int main() {
   glMatrixMode(GL_MODELVIEW);
   glLoadIdentity();
 
-  while (!glfwWindowShouldClose(window)) {
+  Scene scene;
+  buildLogo(scene);
+  GLSceneCache sceneCache;
+
+  // The logo never changes, so it is painted only when the window asks.
+  while (waitForRepaint(window)) {
+    CG_PROFILE_FRAME();
+    // The ortho box spans the window in screen coordinates; the framebuffer
+    // can be denser (HiDPI), which the tessellation tolerance must follow.
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    scene.setPixelsPerUnit(float(framebufferWidth) / width);
+
     glClear(GL_COLOR_BUFFER_BIT);
 
     // Draw the Nepal Tourism Board logo
-    drawLogo();
+    {
+      CG_PROFILE_SCOPE("drawLogo");
+      sceneCache.draw(scene);
+    }
 
+    CG_PROFILE_OVERLAY(window, "Nepal Tourism Board Logo");
     glfwSwapBuffers(window);
-    glfwPollEvents();
   }
+  CG_PROFILE_FINISH();
 
   glfwDestroyWindow(window);
   glfwTerminate();
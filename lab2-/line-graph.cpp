@@ -1,111 +1,24 @@
 #include <GL/gl.h>
 #include <GLFW/glfw3.h>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
-GLFWwindow *initializeGLFW() {
-  if (!glfwInit()) {
-    std::cerr << "Failed to initialize GLFW" << std::endl;
-  }
-  GLFWmonitor *primaryMonitor = glfwGetPrimaryMonitor();
-  if (!primaryMonitor) {
-    std::cerr << "Failed to get primary monitor" << std::endl;
-    glfwTerminate();
-  }
-  const GLFWvidmode *videoMode = glfwGetVideoMode(primaryMonitor);
-  if (!videoMode) {
-    std::cerr << "Failed to get video mode of the primary monitor" << std::endl;
-    glfwTerminate();
-  }
-  GLFWwindow *window = glfwCreateWindow(videoMode->width, videoMode->height,
-                                        "Hello World", NULL, NULL);
-  if (!window) {
-    glfwTerminate();
-    std::cerr << "Failed to create GLFW window" << std::endl;
-  }
-  return window;
-}
-
-// 0 -5 20 10
-void drawLineDDA(float start_x, float start_y, float end_x, float end_y) {
-  float slope, step_size, x_inc, y_inc;
-  // Avoid division by zero
-  if (end_x - start_x != 0) {
-    slope = (float)(end_y - start_y) / (end_x - start_x);
-    // std::cout << "The slope of the line is: " << slope << std::endl;
-  } else {
-    // std::cout << "The line is vertical; slope is undefined." << std::endl;
-  }
-
-  step_size = abs(end_x - start_x) > abs(end_y - start_y)
-                  ? abs(end_x - start_x)
-                  : abs(end_y - start_y);
-  x_inc = (end_x - start_x) / step_size;
-  y_inc = (end_y - start_y) / step_size;
-
-  glColor3f(1.0f, 0.0f, 0.0f);
-  // glPointSize(5.0f);
-
-  glBegin(GL_POINTS);
-
-  int i = 0;
-  while (i != step_size) {
-    // std::cout << start_x << ", " << start_y << std::endl;
-    glVertex2f(start_x, start_y);
-    start_x += x_inc;
-    start_y += y_inc;
-    i++;
-  }
-
-  // std::cout << start_x + x_inc << ", " << start_y + y_inc << std::endl;
-  // std::cout << end_x << ", " << end_y << std::endl;
-
-  glEnd();
-}
-
-void bresenham(int x1, int y1, int x2, int y2) {
-  int dx = abs(x2 - x1);
-  int dy = abs(y2 - y1);
-  int sx = (x1 < x2) ? 1 : -1;
-  int sy = (y1 < y2) ? 1 : -1;
-  int x = x1, y = y1;
-
-  // glPointSize(5.0f);
-  glColor3f(1.0f, 0.0f, 0.0f);
-  glBegin(GL_POINTS);
-
-  if (dx > dy) {
-    // Slope < 1
-    int pk = 2 * dy - dx;
-    while (x != x2) {
-      glVertex2i(x, y);
-      if (pk >= 0) {
-        y += sy;
-        pk -= 2 * dx;
-      }
-      pk += 2 * dy;
-      x += sx;
-    }
-  } else {
-    // Slope >= 1
-    int pk = 2 * dx - dy;
-    while (y != y2) {
-      glVertex2i(x, y);
-      if (pk >= 0) {
-        x += sx;
-        pk -= 2 * dy;
-      }
-      pk += 2 * dx;
-      y += sy;
-    }
-  }
-
-  glVertex2i(x, y); // Plot the final point
-  glEnd();
-}
-
-void drawLineGraph(const std::vector<int> &yValues, int xStart, int xStep) {
+#include "../common/batch_raster.h"
+#include "../common/framebuffer.h"
+#include "../common/geometry_file.h"
+#include "../common/gl_draw.h"
+#include "../common/mapped_file.h"
+#include "../common/raster.h"
+#include "../common/scene.h"
+#include "../common/stream_chart.h"
+#include "../common/window.h"
+
+void drawLineGraph(PixelSink &sink, const std::vector<int> &yValues,
+                   int xStart, int xStep) {
   for (size_t i = 0; i < yValues.size() - 1; ++i) {
     int x1 = xStart + i * xStep;
     int y1 = yValues[i];
@@ -113,28 +26,93 @@ void drawLineGraph(const std::vector<int> &yValues, int xStart, int xStep) {
     int y2 = yValues[i + 1];
 
     // Draw line between consecutive points
-    bresenham(x1, y1, x2, y2);
+    bresenhamSpans(sink, x1, y1, x2, y2);
+  }
+}
+
+// Same segments as drawLineGraph, for the parallel batch rasterizer
+std::vector<Segment> lineGraphSegments(const std::vector<int> &yValues,
+                                       int xStart, int xStep, Color color) {
+  std::vector<Segment> segments;
+  for (size_t i = 0; i + 1 < yValues.size(); ++i) {
+    int x1 = xStart + i * xStep;
+    int x2 = xStart + (i + 1) * xStep;
+    segments.push_back({x1, yValues[i], x2, yValues[i + 1], color});
   }
+  return segments;
+}
+
+// Define some example y-values for the line graph
+const std::vector<int> yValues = {10, 30, 25, 40, 20, 35, 50, 45};
+const int xStart = 50; // Starting x-coordinate
+const int xStep = 20;  // Horizontal distance between points
+const Color lineColor(255, 0, 0); // Red lines
+
+void renderLineGraph(PixelSink &sink) {
+  sink.setColor(lineColor);
+  drawLineGraph(sink, yValues, xStart, xStep);
 }
 
 // Display callback for OpenGL
-void displayLineGraph() {
+void displayLineGraph(Scene &scene, GLSceneCache &sceneCache) {
+  CG_PROFILE_SCOPE("displayLineGraph");
   glClear(GL_COLOR_BUFFER_BIT);
 
-  // Define some example y-values for the line graph
-  std::vector<int> yValues = {10, 30, 25, 40, 20, 35, 50, 45};
-  int xStart = 50; // Starting x-coordinate
-  int xStep = 20;  // Horizontal distance between points
-
-  glColor3f(0.0f, 0.0f, 0.0f); // Set color to black
-  drawLineGraph(yValues, xStart, xStep);
+  sceneCache.draw(scene);
 
   glFlush();
 }
 
-int main() {
+int main(int argc, char **argv) {
+  // Headless mode: ./line-graph out.png [width height [series.i32|graph.cgb]]
+  // A series file holds raw int32 samples and is plotted across the full
+  // width with per-column decimation. A geometry file is drawn straight from
+  // its mapping at the size it was saved with, scene first, then segments.
+  std::string input = argc > 4 ? argv[4] : "";
+  if (input.size() > 4 && input.compare(input.size() - 4, 4, ".cgb") == 0) {
+    GeometryFile graph(input);
+    if (!graph.isOpen()) {
+      return -1;
+    }
+    Framebuffer framebuffer(graph.data().scene.width,
+                            graph.data().scene.height);
+    renderGeometry(graph.data(), framebuffer);
+    return framebuffer.save(argv[1]) ? 0 : -1;
+  }
+  if (argc > 4) {
+    int width = atoi(argv[2]);
+    int height = atoi(argv[3]);
+    MappedFile series(argv[4]);
+    size_t count = series.size() / sizeof(int32_t);
+    if (!series.isOpen() || count == 0) {
+      std::cerr << "No samples in " << argv[4] << std::endl;
+      return -1;
+    }
+    Framebuffer framebuffer(width, height);
+    StreamingChart chart(framebuffer.bounds().xmin, double(width) / count,
+                         size_t(width));
+    chart.push(reinterpret_cast<const int *>(series.data()), count);
+    chart.flush();
+    framebuffer.setColor(lineColor);
+    chart.drawNew(framebuffer);
+    return framebuffer.save(argv[1]) ? 0 : -1;
+  }
+  if (argc > 1) {
+    int width = argc > 3 ? atoi(argv[2]) : 1920;
+    int height = argc > 3 ? atoi(argv[3]) : 1080;
+    Framebuffer framebuffer(width, height);
+    ThreadPool pool;
+    rasterizeSegments(framebuffer,
+                      lineGraphSegments(yValues, xStart, xStep, lineColor),
+                      pool);
+    return framebuffer.save(argv[1]) ? 0 : -1;
+  }
+
   // Initialize GLFW
-  GLFWwindow *window = initializeGLFW();
+  GLFWwindow *window = initializeGLFW("Hello World");
+  if (!window) {
+    return -1;
+  }
   glfwMakeContextCurrent(window);
 
   // Set the clear color (white background)
@@ -144,16 +122,23 @@ int main() {
   glfwGetWindowSize(window, &width, &height);
   glOrtho(-width / 2.0, width / 2.0, -height / 2.0, height / 2.0, -1.0, 1.0);
 
-  // Main render loop
-  while (!glfwWindowShouldClose(window)) {
+  // The graph is rasterized once and redrawn from the cache
+  Scene scene;
+  scene.add<RasterShape>(renderLineGraph);
+  GLSceneCache sceneCache;
+
+  // Main render loop: the graph is static, so it is painted only when the
+  // window needs it
+  while (waitForRepaint(window)) {
+    CG_PROFILE_FRAME();
     // Clear the screen
     glClear(GL_COLOR_BUFFER_BIT);
     // bresenham(0, -5, 300, 400);
-    displayLineGraph();
+    displayLineGraph(scene, sceneCache);
+    CG_PROFILE_OVERLAY(window, "Hello World");
     glfwSwapBuffers(window);
-    // Poll for and process events
-    glfwPollEvents();
   }
+  CG_PROFILE_FINISH();
 
   // Clean up and close the window
   glfwDestroyWindow(window);
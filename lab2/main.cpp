@@ -1,105 +1,31 @@
 #include <GL/gl.h>
 #include <GLFW/glfw3.h>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 
-#define PI 3.14159265
-
-// Initialize GLFW and create a window
-GLFWwindow *initializeGLFW() {
-    if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
-        return nullptr;
-    }
-
-    GLFWmonitor *primaryMonitor = glfwGetPrimaryMonitor();
-    if (!primaryMonitor) {
-        std::cerr << "Failed to get primary monitor" << std::endl;
-        glfwTerminate();
-        return nullptr;
-    }
+#include "../common/framebuffer.h"
+#include "../common/gl_draw.h"
+#include "../common/raster.h"
+#include "../common/scene.h"
+#include "../common/window.h"
 
-    const GLFWvidmode *videoMode = glfwGetVideoMode(primaryMonitor);
-    if (!videoMode) {
-        std::cerr << "Failed to get video mode" << std::endl;
-        glfwTerminate();
-        return nullptr;
-    }
-
-    GLFWwindow *window = glfwCreateWindow(videoMode->width, videoMode->height, "Line Drawing Algorithm", NULL, NULL);
-    if (!window) {
-        glfwTerminate();
-        std::cerr << "Failed to create GLFW window" << std::endl;
-        return nullptr;
-    }
+#define PI 3.14159265
 
-    return window;
-}
+// Rasterize the selected algorithm's line into the sink. Only the part inside
+// the viewport is stepped through, however far off screen the endpoints are
+void drawLine(PixelSink &sink, const Rect &viewport, int n, int x0, int y0,
+              int x1, int y1) {
+    sink.setColor(Color(0, 0, 0));  // Black points
 
-// Bresenham Line Algorithm to plot points
-void bresenham(int x1, int y1, int x2, int y2) {
-    int dx = abs(x2 - x1);
-    int dy = abs(y2 - y1);
-    double m = static_cast<double>(dy) / dx;
-    int dx2 = 2 * dx;
-    int dy2 = 2 * dy;
-
-    int sx = (x1 < x2) ? 1 : -1;
-    int sy = (y1 < y2) ? 1 : -1;
-
-    int x = x1, y = y1;
-
-    glColor3f(0.0f, 0.0f, 0.0f);
-    glBegin(GL_POINTS);
-
-    if (m < 1) {
-        int pk = dy2 - dx;
-        while (x != x2) {
-            glVertex2f(x, y);
-            if (pk >= 0) {
-                y += sy;
-                pk -= dx2;
-            }
-            pk += dy2;
-            x += sx;
-        }
+    if (n == 1) {
+        DDA_lineSpans(sink, viewport, x0, y0, x1, y1);
     } else {
-        int pk = dx2 - dy;
-        while (y != y2) {
-            glVertex2f(x, y);
-            if (pk >= 0) {
-                x += sx;
-                pk -= dy2;
-            }
-            pk += dx2;
-            y += sy;
-        }
+        bresenhamSpans(sink, viewport, x0, y0, x1, y1);
     }
-
-    glVertex2f(x, y);
-    glEnd();
-}
-
-// DDA Line Algorithm to plot points
-void DDA_line(int x1, int y1, int x2, int y2) {
-    int dx = x2 - x1, dy = y2 - y1;
-    int steps = std::max(abs(dx), abs(dy));
-    float xInc = dx / float(steps), yInc = dy / float(steps);
-    float x = x1, y = y1;
-
-    glColor3f(0.0f, 0.0f, 0.0f);  // Set point color to black
-    glBegin(GL_POINTS);  // Start drawing points
-
-    for (int i = 0; i <= steps; i++) {
-        glVertex2f(round(x), round(y));  // Plot the point
-        x += xInc;
-        y += yInc;
-    }
-
-    glEnd();  // End drawing points
 }
 
-int main() {
+int main(int argc, char **argv) {
     int x0, y0, x1, y1, n;
 
     std::cout << "Enter starting points (x0, y0): ";
@@ -112,9 +38,23 @@ int main() {
     std::cout << "1. DDA Algorithm" << std::endl;
     std::cout << "2. Bresenham Algorithm" << std::endl;
     std::cin >> n;
+    if (n != 1 && n != 2) {
+        std::cerr << "Invalid algorithm choice" << std::endl;
+        return -1;
+    }
+
+    // Headless mode: ./Algorithm out.png [width height] renders the line into
+    // an image without opening a window
+    if (argc > 1) {
+        int width = argc > 3 ? atoi(argv[2]) : 1920;
+        int height = argc > 3 ? atoi(argv[3]) : 1080;
+        Framebuffer framebuffer(width, height);
+        drawLine(framebuffer, framebuffer.bounds(), n, x0, y0, x1, y1);
+        return framebuffer.save(argv[1]) ? 0 : -1;
+    }
 
     // Initialize GLFW and create the window
-    GLFWwindow *window = initializeGLFW();
+    GLFWwindow *window = initializeGLFW("Line Drawing Algorithm");
     if (!window) return -1;
 
     glfwMakeContextCurrent(window);
@@ -131,25 +71,26 @@ int main() {
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
-    // Main rendering loop
-    while (!glfwWindowShouldClose(window)) {
+    // The line is rasterized once into the scene cache and redrawn from it
+    Scene scene;
+    Rect viewport = centeredRect(width, height);
+    scene.add<RasterShape>([=](PixelSink &sink) {
+        drawLine(sink, viewport, n, x0, y0, x1, y1);
+    });
+    GLSceneCache sceneCache;
+
+    // Main rendering loop: the line is static, so it is painted only when
+    // the window needs it
+    while (waitForRepaint(window)) {
+        CG_PROFILE_FRAME();
         glClear(GL_COLOR_BUFFER_BIT);
 
-        switch (n) {
-        case 1:
-            DDA_line(x0, y0, x1, y1);
-            break;
-        case 2:
-            bresenham(x0, y0, x1, y1);
-            break;
-        default:
-            glfwSetWindowShouldClose(window, GLFW_TRUE);
-            break;
-        }
+        sceneCache.draw(scene);
 
+        CG_PROFILE_OVERLAY(window, "Line Drawing Algorithm");
         glfwSwapBuffers(window);
-        glfwPollEvents();
     }
+    CG_PROFILE_FINISH();
 
     glfwDestroyWindow(window);
     glfwTerminate();
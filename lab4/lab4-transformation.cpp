@@ -1,134 +1,187 @@
 #include <GL/gl.h>
 #include <GLFW/glfw3.h>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
-#include <thread>
-#include <chrono> 
+#include <string>
 #include <vector>
 
+#include "../common/damage.h"
+#include "../common/frame_scheduler.h"
+#include "../common/framebuffer.h"
+#include "../common/gl_draw.h"
+#include "../common/instancing.h"
+#include "../common/thread_pool.h"
+#include "../common/transform.h"
+#include "../common/window.h"
+
 using namespace std;
 
 class Transformation {
 public:
-    static GLFWwindow *initializeGLFW() {
-      if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
-      }
-      GLFWmonitor *primaryMonitor = glfwGetPrimaryMonitor();
-      if (!primaryMonitor) {
-        std::cerr << "Failed to get primary monitor" << std::endl;
-        glfwTerminate();
-      }
-      const GLFWvidmode *videoMode = glfwGetVideoMode(primaryMonitor);
-      if (!videoMode) {
-        std::cerr << "Failed to get video mode of the primary monitor" << std::endl;
-        glfwTerminate();
-      }
-      GLFWwindow *window = glfwCreateWindow(videoMode->width, videoMode->height,
-                                            "2D Transformation", NULL, NULL);
-      if (!window) {
-        glfwTerminate();
-        std::cerr << "Failed to create GLFW window" << std::endl;
-      }
-      return window;
-    }
-
-    static void plotPoints(vector<vector<float>> points) {
+    static void plotPoints(const PointBuffer &points) {
       glBegin(GL_POLYGON);
-      for (auto& point : points) {
-          glVertex2f(point[0], point[1]);
+      for (size_t i = 0; i < points.size(); i++) {
+          glVertex2f(points.x()[i], points.y()[i]);
       }
       glEnd();
     }
 
-    // Matrix multiplication
-    static void applyTransformation(vector<vector<float>>& points, float transformationMatrix[3][3]){
-      for (auto& point : points) {
-          vector<float> result(3, 0);
-          for (int i = 0; i < 3; i++) {
-              for (int j = 0; j < 3; j++) {
-                  result[i] += transformationMatrix[i][j] * point[j];
-              }
-          }
-          point = result;
-      }
+    // Apply the affine matrix to every point in place (SIMD, no allocation)
+    static void applyTransformation(PointBuffer &points, const Transform2D &transformationMatrix) {
+      applyTransform(transformationMatrix, points);
+    }
+
+    // Transform source into result, leaving the source geometry untouched
+    static void applyTransformation(const PointBuffer &source, const Transform2D &transformationMatrix, PointBuffer &result) {
+      applyTransform(transformationMatrix, source, result);
+    }
+
+    // Chain transforms so they cost a single pass: first is applied first
+    static Transform2D compose(const Transform2D &first, const Transform2D &second) {
+      return second * first;
     }
 
     // Translation matrix
-    static void translate(float matrix[3][3], float tx, float ty) {
-        matrix[0][0] = 1; matrix[0][1] = 0; matrix[0][2] = tx;
-        matrix[1][0] = 0; matrix[1][1] = 1; matrix[1][2] = ty;
-        matrix[2][0] = 0; matrix[2][1] = 0; matrix[2][2] = 1;
+    static Transform2D translate(float tx, float ty) {
+        return Transform2D::translation(tx, ty);
     }
 
     // Scaling matrix
-    static void scale(float matrix[3][3], float sx, float sy) {
-        matrix[0][0] = sx; matrix[0][1] = 0;  matrix[0][2] = 0;
-        matrix[1][0] = 0;  matrix[1][1] = sy; matrix[1][2] = 0;
-        matrix[2][0] = 0;  matrix[2][1] = 0;  matrix[2][2] = 1;
+    static Transform2D scale(float sx, float sy) {
+        return Transform2D::scaling(sx, sy);
     }
 
     // Rotation matrix
-    static void rotate(float matrix[3][3], float angle) {
-        float rad = angle * M_PI / 180;
-        matrix[0][0] = cos(rad); matrix[0][1] = -sin(rad); matrix[0][2] = 0;
-        matrix[1][0] = sin(rad); matrix[1][1] = cos(rad);  matrix[1][2] = 0;
-        matrix[2][0] = 0;        matrix[2][1] = 0;         matrix[2][2] = 1;
+    static Transform2D rotate(float angle) {
+        return Transform2D::rotation(angle);
     }
 
 };
 
-void windmill() {
-    // Define the blades of the windmill as triangles in homogeneous coordinates
-    vector<vector<float>> blade1 = { {0, 0, 1}, {20, 100, 1}, {-20, 100, 1} };
-    vector<vector<float>> blade2 = { {0, 0, 1}, {20, -100, 1}, {-20, -100, 1} };
-    vector<vector<float>> blade3 = { {0, 0, 1}, {100, 20, 1}, {100, -20, 1} };
-    vector<vector<float>> blade4 = { {0, 0, 1}, {-100, 20, 1}, {-100, -20, 1} };
-
-    float angle = 0.0f; // Initial angle
-
-    while (!glfwWindowShouldClose(glfwGetCurrentContext())) {
-        // Clear the screen
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // Create the rotation matrix for the current angle
-        float rotationMatrix[3][3];
-        Transformation::rotate(rotationMatrix, angle);
-
-        // Apply the rotation to each blade
-        Transformation::applyTransformation(blade1, rotationMatrix);
-        Transformation::applyTransformation(blade2, rotationMatrix);
-        Transformation::applyTransformation(blade3, rotationMatrix);
-        Transformation::applyTransformation(blade4, rotationMatrix);
+// The windmill is one blade mesh instanced four times: rotated by 0, 180, -90
+// and 90 degrees around the hub, then by the current animation angle
+void windmillBlades(InstanceBatch &blades, float angle) {
+    static const float bladeAngles[4] = {0.0f, 180.0f, -90.0f, 90.0f};
+    static const Color bladeColors[4] = {
+        Color(255, 0, 0),   // Red color for blade 1
+        Color(0, 255, 0),   // Green color for blade 2
+        Color(0, 0, 255),   // Blue color for blade 3
+        Color(255, 255, 0), // Yellow color for blade 4
+    };
+
+    if (blades.mesh.empty()) {
+        blades.mesh = { {0, 0}, {20, 100}, {-20, 100} };
+    }
 
-        // Draw each blade
-        glColor3f(1.0f, 0.0f, 0.0f); // Red color for blade 1
-        Transformation::plotPoints(blade1);
+    TransformStack stack;
+    stack.rotate(angle);
+    blades.clear();
+    for (int i = 0; i < 4; i++) {
+        stack.push();
+        stack.rotate(bladeAngles[i]);
+        blades.add(stack.top(), bladeColors[i]);
+        stack.pop();
+    }
+}
 
-        glColor3f(0.0f, 1.0f, 0.0f); // Green color for blade 2
-        Transformation::plotPoints(blade2);
+// Rotation speed of the blades
+const float degreesPerSecond = 60.0f;
+
+// Animate the windmill until the window is closed. Each frame starts by
+// waiting for its slot and polling input, so events are handled within one
+// frame, and the angle advances by elapsed time rather than per frame.
+//
+// With software set the blades are rasterized into a framebuffer that is
+// kept between frames: only the rectangles the blades covered last frame or
+// cover now are cleared, redrawn and uploaded, so the cost follows the
+// blades' area rather than the window's.
+void windmill(GLFWwindow *window, double targetFps, bool software) {
+    InstanceBatch blades;
+    InstanceVertices vertices;
+    FrameScheduler scheduler(targetFps);
+
+    int width, height;
+    glfwGetWindowSize(window, &width, &height);
+    const Color background(255, 255, 255);
+    Framebuffer framebuffer(software ? width : 0, software ? height : 0);
+    framebuffer.clear(background);
+    DamageTracker damage(framebuffer.bounds());
+    GLFramebufferTexture texture;
+    // Only the software path rasterizes; the GL path needs no workers
+    ThreadPool pool(software ? std::thread::hardware_concurrency() : 1);
 
-        glColor3f(0.0f, 0.0f, 1.0f); // Blue color for blade 3
-        Transformation::plotPoints(blade3);
+    float angle = 0.0f; // Initial angle
 
-        glColor3f(1.0f, 1.0f, 0.0f); // Yellow color for blade 4
-        Transformation::plotPoints(blade4);
+    while (!glfwWindowShouldClose(window)) {
+        double dt = scheduler.beginFrame();
+        CG_PROFILE_FRAME();
 
-        angle += 1.0f;
-        if (angle >= 360.0f) {
-            angle = 0.0f;
+        // Poll for and process events
+        glfwPollEvents();
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
 
-        glfwSwapBuffers(glfwGetCurrentContext());
-        glfwPollEvents();
+        angle = fmodf(angle + degreesPerSecond * float(dt), 360.0f);
+
+        // Update the per-instance transforms and draw all blades at once
+        {
+            CG_PROFILE_SCOPE("windmill");
+            windmillBlades(blades, angle);
+            if (software) {
+                texture.update(framebuffer,
+                               redrawInstances(framebuffer, blades, damage,
+                                               background, pool));
+                texture.draw();
+            } else {
+                glClear(GL_COLOR_BUFFER_BIT);
+                drawInstances(blades, vertices);
+            }
+        }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        CG_PROFILE_OVERLAY(window, "2D Transformation");
+        glfwSwapBuffers(window);
     }
+    CG_PROFILE_FINISH();
+
+    FrameScheduler::Stats stats = scheduler.stats();
+    std::cout << "Frames: " << stats.frames << ", frame time (ms) min "
+              << stats.minMs << " avg " << stats.avgMs << " p99 "
+              << stats.p99Ms << " max " << stats.maxMs << std::endl;
 }
 
+int main(int argc, char **argv) {
+  // ./lab4 --software animates the windmill with the software rasterizer
+  // and dirty-rectangle redraw instead of GL triangles
+  bool software = argc > 1 && std::string(argv[1]) == "--software";
+
+  // Headless mode: ./lab4 out.png [width height [angle]] renders one frame
+  // of the windmill with the tiled software rasterizer, scaled to keep its
+  // size relative to a 1080-line screen
+  if (argc > 1 && !software) {
+    int width = argc > 3 ? atoi(argv[2]) : 1920;
+    int height = argc > 3 ? atoi(argv[3]) : 1080;
+    float angle = argc > 4 ? atof(argv[4]) : 0.0f;
+    Framebuffer framebuffer(width, height);
+    ThreadPool pool;
+    CG_PROFILE_FRAME();
+    InstanceBatch blades;
+    windmillBlades(blades, angle);
+    float scale = height / 1080.0f;
+    for (Transform2D &transform : blades.transforms) {
+      transform = Transform2D::scaling(scale, scale) * transform;
+    }
+    rasterizeInstances(framebuffer, blades, pool);
+    CG_PROFILE_FRAME();
+    CG_PROFILE_FINISH();
+    return framebuffer.save(argv[1]) ? 0 : -1;
+  }
 
-int main() {
-  GLFWwindow *window = Transformation::initializeGLFW();
+  GLFWwindow *window = initializeGLFW("2D Transformation");
+  if (!window) {
+    return -1;
+  }
   glfwMakeContextCurrent(window);
 
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -137,30 +190,29 @@ int main() {
   glfwGetWindowSize(window, &width, &height);
   glOrtho(-width / 2.0, width / 2.0, -height / 2.0, height / 2.0, -1.0, 1.0);
 
-  while (!glfwWindowShouldClose(window)) {
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    vector<vector<float>> points = {{0, 0, 1},{100,10,1},{10,100,1}}; 
-
-    glColor3f(1.0f, 0.0f, 0.0f); 
-    // Transformation::plotPoints(points);
-    //
-    // // Translation
-    // float tranformMatrix[3][3];
-    // Transformation::scale(tranformMatrix,2,2);
-    // Transformation::applyTransformation(points,tranformMatrix);
-    //
-    //
-    // // Draw the translated point
-    // glBegin(GL_POLYGON);
-    // glColor3f(0.0f, 1.0f, 0.0f); // Red color
-    // Transformation::plotPoints(points);
-    windmill();
-
-    glfwSwapBuffers(window);
-    // Poll for and process events
-    glfwPollEvents();
-  }
+  // PointBuffer points = {{0, 0}, {100, 10}, {10, 100}};
+  //
+  // glColor3f(1.0f, 0.0f, 0.0f);
+  // Transformation::plotPoints(points);
+  //
+  // // Translation
+  // Transform2D tranformMatrix = Transformation::scale(2, 2);
+  // Transformation::applyTransformation(points, tranformMatrix);
+  //
+  //
+  // // Draw the translated point
+  // glBegin(GL_POLYGON);
+  // glColor3f(0.0f, 1.0f, 0.0f); // Red color
+  // Transformation::plotPoints(points);
+
+  // Pace the animation to the monitor's refresh rate; the frame scheduler
+  // does the waiting, so buffer swaps do not block on vsync.
+  const GLFWvidmode *videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+  double targetFps = videoMode && videoMode->refreshRate > 0
+                         ? videoMode->refreshRate
+                         : 60.0;
+  glfwSwapInterval(0);
+  windmill(window, targetFps, software);
 
   // Clean up and close the window
   glfwDestroyWindow(window);
@@ -0,0 +1,124 @@
+// rasterizeSegments() and stampCircles() against drawing the same shapes one
+// after another into one framebuffer, for several band heights and thread
+// counts. Overlapping shapes of different colors make the drawing order
+// visible, and some cross or miss the framebuffer. Exits non-zero on the
+// first mismatching image.
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../common/batch_raster.h"
+#include "../common/circle_stamp.h"
+#include "../common/raster.h"
+
+namespace {
+
+// Odd sizes, so the last band is a partial one.
+const int kWidth = 301, kHeight = 203;
+// More than one binning chunk of rasterizeSegments().
+const int kSegments = 9000;
+const int kCircles = 3000;
+
+bool same(const Framebuffer &a, const Framebuffer &b, const std::string &what) {
+  for (int r = 0; r < a.height(); ++r) {
+    for (int c = 0; c < a.width(); ++c) {
+      if (a.row(r)[c] != b.row(r)[c]) {
+        std::cerr << what << " differs from serial drawing at column " << c
+                  << ", row " << r << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Color randomColor(std::mt19937 &rng) {
+  return Color(uint8_t(rng()), uint8_t(rng()), uint8_t(rng()));
+}
+
+bool checkSegments(ThreadPool &pool) {
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<int> x(-kWidth, kWidth);
+  std::uniform_int_distribution<int> y(-kHeight, kHeight);
+  std::uniform_int_distribution<int> nearby(-20, 20);
+  std::vector<Segment> segments;
+  for (int i = 0; i < kSegments; ++i) {
+    Segment s{x(rng), y(rng), 0, 0, randomColor(rng)};
+    bool shortOne = i % 2 == 0;
+    s.x2 = shortOne ? s.x1 + nearby(rng) : x(rng);
+    s.y2 = shortOne ? s.y1 + nearby(rng) : y(rng);
+    segments.push_back(s);
+  }
+
+  Framebuffer serial(kWidth, kHeight);
+  serial.clear(Color());
+  for (const Segment &s : segments) {
+    serial.setColor(s.color);
+    bresenhamSpans(serial, s.x1, s.y1, s.x2, s.y2);
+  }
+  for (int bandHeight : {1, 7, 32, 1000}) {
+    Framebuffer banded(kWidth, kHeight);
+    banded.clear(Color());
+    rasterizeSegments(banded, segments, pool, bandHeight);
+    if (!same(banded, serial,
+              "rasterizeSegments(bandHeight = " + std::to_string(bandHeight) +
+                  ")")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool checkCircles(ThreadPool &pool) {
+  std::mt19937 rng(6);
+  std::uniform_int_distribution<int> x(-kWidth / 2 - 60, kWidth / 2 + 60);
+  std::uniform_int_distribution<int> y(-kHeight / 2 - 60, kHeight / 2 + 60);
+  std::vector<CircleCenter> centers;
+  for (int i = 0; i < kCircles; ++i) {
+    centers.push_back({x(rng), y(rng), randomColor(rng)});
+  }
+
+  for (int radius : {0, 3, 40}) {
+    for (bool filled : {false, true}) {
+      Framebuffer serial(kWidth, kHeight);
+      serial.clear(Color());
+      for (const CircleCenter &c : centers) {
+        serial.setColor(c.color);
+        if (filled) {
+          fillCircle(serial, c.x, c.y, radius);
+        } else {
+          midPointCircle(serial, c.x, c.y, radius);
+        }
+      }
+      const CircleStamp &stamp = circleStamp(radius, filled);
+      for (int bandHeight : {1, 16, 128, 1000}) {
+        Framebuffer banded(kWidth, kHeight);
+        banded.clear(Color());
+        stampCircles(banded, stamp, centers, pool, bandHeight);
+        std::string what = "stampCircles(radius = " + std::to_string(radius) +
+                           (filled ? ", filled" : "") + ", bandHeight = " +
+                           std::to_string(bandHeight) + ")";
+        if (!same(banded, serial, what)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main() {
+  for (unsigned threads : {1u, 4u}) {
+    ThreadPool pool(threads);
+    if (!checkSegments(pool) || !checkCircles(pool)) {
+      return 1;
+    }
+  }
+  std::cout << "banded batches match serial drawing" << std::endl;
+  return 0;
+}
@@ -0,0 +1,421 @@
+// The clipped overloads in raster.h against the unclipped functions drawn
+// through a ClipSink, on random shapes and windows; the DDA lines may only
+// differ where raster.h says they do, at positions within float drift of a
+// half pixel. Every window is also checked pixel by pixel against the
+// algorithms' closed forms in 128 bits, which is all that shapes reaching
+// the ends of the int range, too long to draw unclipped, are checked against.
+// Exits non-zero on the first mismatch.
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../common/clip.h"
+#include "../common/raster.h"
+
+namespace {
+
+using int128 = __int128;
+
+const int kRandomCases = 20000;
+
+uint64_t key(int x, int y) {
+  return uint64_t(uint32_t(y)) << 32 | uint32_t(x);
+}
+
+// Records every pixel, however it arrives, as a sorted set.
+class PixelRecorder : public PixelSink {
+public:
+  void setColor(Color) override {}
+  void plot(int x, int y) override { pixels_.push_back(key(x, y)); }
+
+  std::vector<uint64_t> pixels() {
+    std::sort(pixels_.begin(), pixels_.end());
+    pixels_.erase(std::unique(pixels_.begin(), pixels_.end()), pixels_.end());
+    return pixels_;
+  }
+
+private:
+  std::vector<uint64_t> pixels_;
+};
+
+// Pixels of clip for which onShape(x, y) holds.
+template <typename OnShape>
+std::vector<uint64_t> pixelsWhere(const Rect &clip, OnShape onShape) {
+  std::vector<uint64_t> pixels;
+  for (int y = clip.ymin; y <= clip.ymax; ++y) {
+    for (int x = clip.xmin; x <= clip.xmax; ++x) {
+      if (onShape(x, y)) {
+        pixels.push_back(key(x, y));
+      }
+    }
+  }
+  std::sort(pixels.begin(), pixels.end());
+  return pixels;
+}
+
+// Smallest i in [lo, hi] for which pred(i) holds, or hi + 1.
+template <typename Pred> int64_t search(int64_t lo, int64_t hi, Pred pred) {
+  while (lo <= hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (pred(mid)) {
+      hi = mid - 1;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+std::string describe(const Rect &clip) {
+  return "clipped to (" + std::to_string(clip.xmin) + ", " +
+         std::to_string(clip.ymin) + ") - (" + std::to_string(clip.xmax) +
+         ", " + std::to_string(clip.ymax) + ")";
+}
+
+bool report(bool same, const std::string &what, const Rect &clip) {
+  if (!same) {
+    std::cerr << what << " " << describe(clip) << " differs" << std::endl;
+  }
+  return same;
+}
+
+// A random window of up to 80 x 80 pixels near the origin.
+Rect randomClip(std::mt19937 &rng) {
+  auto coordinate = [&](int m) { return int(rng() % (2 * m + 1)) - m; };
+  Rect clip{coordinate(100), coordinate(100), 0, 0};
+  clip.xmax = clip.xmin + int(rng() % 80);
+  clip.ymax = clip.ymin + int(rng() % 80);
+  return clip;
+}
+
+// Lines ------------------------------------------------------------------
+
+using LineFunction = void (*)(PixelSink &, int, int, int, int);
+using ClippedLineFunction = void (*)(PixelSink &, const Rect &, int, int, int,
+                                     int);
+
+// Pixel i of a line, 0 <= i <= steps, is i steps from (x1, y1) along the
+// major axis and minorAt(i) along the minor one: for bresenham() the
+// decision term's floor((2 minor i + major) / (2 major)), for DDA_line() the
+// exact position rounded half away from zero.
+struct Line {
+  int64_t a0, b0, steps, db;
+  int sa;
+  bool xMajor, dda;
+
+  Line(int x1, int y1, int x2, int y2, bool dda) : dda(dda) {
+    int64_t dx = int64_t(x2) - x1, dy = int64_t(y2) - y1;
+    xMajor = dda ? std::abs(dx) >= std::abs(dy) : std::abs(dx) > std::abs(dy);
+    a0 = xMajor ? x1 : y1;
+    b0 = xMajor ? y1 : x1;
+    steps = xMajor ? std::abs(dx) : std::abs(dy);
+    db = xMajor ? dy : dx;
+    sa = (xMajor ? dx : dy) >= 0 ? 1 : -1;
+  }
+  int64_t minorAt(int64_t i) const {
+    if (steps == 0) {
+      return b0;
+    }
+    int128 n = int128(db) * i;
+    if (dda) {
+      n += int128(b0) * steps;
+      return int64_t(n >= 0 ? (2 * n + steps) / (2 * steps)
+                            : -((-2 * n + steps) / (2 * steps)));
+    }
+    int128 m = (2 * (n < 0 ? -n : n) + steps) / (2 * steps);
+    return b0 + int64_t(n < 0 ? -m : m);
+  }
+  // Step of the pixel at major coordinate a, or -1 past the ends.
+  int64_t step(int64_t a) const {
+    int64_t i = (a - a0) * sa;
+    return i >= 0 && i <= steps ? i : -1;
+  }
+  bool contains(int px, int py) const {
+    int64_t i = step(xMajor ? px : py);
+    return i >= 0 && minorAt(i) == (xMajor ? py : px);
+  }
+  // Whether DDA_line()'s float position at step i may round differently:
+  // the exact position is within float drift of a half pixel.
+  bool nearHalf(int64_t i) const {
+    int128 n = int128(b0) * steps + int128(db) * i;
+    int128 r = (2 * n) % (2 * steps);
+    double off = double(r < 0 ? r + 2 * steps : r) / double(2 * steps);
+    double scale = double(std::max(std::abs(b0), std::abs(b0 + db)) + 1);
+    return std::abs(off - 0.5) <= double(i + 1) * scale * 0x1p-22;
+  }
+};
+
+// Pixels that differ between a and b; both sorted.
+std::vector<uint64_t> differences(const std::vector<uint64_t> &a,
+                                  const std::vector<uint64_t> &b) {
+  std::vector<uint64_t> out;
+  std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(),
+                                std::back_inserter(out));
+  return out;
+}
+
+bool checkLine(const char *name, LineFunction draw,
+               ClippedLineFunction drawClipped, bool dda, const Rect &clip,
+               int x1, int y1, int x2, int y2, bool unclipped) {
+  std::string what = std::string(name) + "(" + std::to_string(x1) + ", " +
+                     std::to_string(y1) + ", " + std::to_string(x2) + ", " +
+                     std::to_string(y2) + ")";
+  Line line(x1, y1, x2, y2, dda);
+  PixelRecorder actual;
+  drawClipped(actual, clip, x1, y1, x2, y2);
+  std::vector<uint64_t> pixels = actual.pixels();
+  auto onLine = [&](int x, int y) { return line.contains(x, y); };
+  if (!report(pixels == pixelsWhere(clip, onLine), what, clip)) {
+    return false;
+  }
+  if (!unclipped) {
+    return true;
+  }
+  PixelRecorder expected;
+  ClipSink clipped(expected, clip);
+  draw(clipped, x1, y1, x2, y2);
+  for (uint64_t k : differences(pixels, expected.pixels())) {
+    int x = int32_t(uint32_t(k)), y = int32_t(k >> 32);
+    if (!dda || !line.nearHalf(line.step(line.xMajor ? x : y))) {
+      return report(false, "unclipped " + what, clip);
+    }
+  }
+  return true;
+}
+
+bool checkLines(int x1, int y1, int x2, int y2, const Rect &clip,
+                bool unclipped) {
+  return checkLine("bresenham", bresenham, bresenham, false, clip, x1, y1,
+                   x2, y2, unclipped) &&
+         checkLine("bresenhamSpans", bresenhamSpans, bresenhamSpans, false,
+                   clip, x1, y1, x2, y2, unclipped) &&
+         checkLine("DDA_line", DDA_line, DDA_line, true, clip, x1, y1, x2, y2,
+                   unclipped) &&
+         checkLine("DDA_lineSpans", DDA_lineSpans, DDA_lineSpans, true, clip,
+                   x1, y1, x2, y2, unclipped);
+}
+
+bool checkLines() {
+  std::mt19937 rng(20);
+  for (int i = 0; i < kRandomCases; ++i) {
+    // Mostly short lines near the window, some long ones crossing it.
+    int m = i % 100 == 0 ? 100000 : 300;
+    auto coordinate = [&]() { return int(rng() % (2 * m + 1)) - m; };
+    Rect clip = randomClip(rng);
+    int x1 = coordinate(), y1 = coordinate();
+    int x2 = coordinate(), y2 = coordinate();
+    if (i % 8 == 1) {
+      y2 = y1 + (x2 - x1) * (rng() % 2 == 0 ? 1 : -1);
+    }
+    if (!checkLines(x1, y1, x2, y2, clip, true)) {
+      return false;
+    }
+  }
+
+  // Lines between the ends of the int range, through or past the window.
+  struct Case {
+    int x1, y1, x2, y2;
+  } cases[] = {{INT_MIN, INT_MIN, INT_MAX, INT_MAX},
+               {INT_MIN, INT_MAX, INT_MAX, INT_MIN},
+               {INT_MIN, 0, INT_MAX, 1},
+               {0, INT_MIN, 1, INT_MAX},
+               {INT_MIN, -50, INT_MAX, 50},
+               {5, INT_MIN, -5, INT_MAX},
+               {-2000000000, -1999999999, 2000000000, 2000000001},
+               {INT_MAX, INT_MAX, -100, 50},
+               {INT_MIN, INT_MIN + 1, INT_MAX, INT_MAX},
+               {INT_MIN, 101, INT_MAX, 101}};
+  for (const Case &c : cases) {
+    for (const Rect &clip : {Rect{-100, -100, 100, 100}, Rect{3, -7, 3, 90}}) {
+      if (!checkLines(c.x1, c.y1, c.x2, c.y2, clip, false)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Circles ----------------------------------------------------------------
+
+// midPointCircle()'s outline: x = 0 .. last with y the largest integer with
+// x^2 + (y - 1/2)^2 < r^2, where last is the first x with x >= y, mirrored
+// into all eight octants.
+struct CircleOutline {
+  int64_t xc, yc, r, last;
+
+  CircleOutline(int64_t xc, int64_t yc, int64_t r) : xc(xc), yc(yc), r(r) {
+    last = search(0, r, [&](int64_t x) { return x >= y(x); });
+  }
+  int64_t y(int64_t x) const {
+    int64_t first = search(0, r, [&](int64_t y) {
+      int128 twice = 2 * int128(y) - 1;
+      return 4 * int128(x) * x + twice * twice >= 4 * int128(r) * r;
+    });
+    return std::max<int64_t>(first - 1, 0);
+  }
+  bool contains(int px, int py) const {
+    int64_t u = px - xc, v = py - yc;
+    u = u < 0 ? -u : u;
+    v = v < 0 ? -v : v;
+    return (u <= last && v == y(u)) || (v <= last && u == y(v));
+  }
+};
+
+bool checkCircles() {
+  std::mt19937 rng(21);
+  for (int i = 0; i < kRandomCases; ++i) {
+    Rect clip = randomClip(rng);
+    int xc = int(rng() % 401) - 200, yc = int(rng() % 401) - 200;
+    int r = int(rng() % 300);
+    PixelRecorder expected, actual;
+    ClipSink clipped(expected, clip);
+    midPointCircle(clipped, xc, yc, r);
+    midPointCircle(actual, clip, xc, yc, r);
+    std::vector<uint64_t> pixels = expected.pixels();
+    CircleOutline outline(xc, yc, r);
+    std::string what = "midPointCircle(" + std::to_string(xc) + ", " +
+                       std::to_string(yc) + ", " + std::to_string(r) + ")";
+    auto onOutline = [&](int x, int y) { return outline.contains(x, y); };
+    if (!report(actual.pixels() == pixels, what, clip) ||
+        !report(pixelsWhere(clip, onOutline) == pixels, "reference for " + what,
+                clip)) {
+      return false;
+    }
+  }
+
+  // Circles much larger than the window: passing near it, crossing it with
+  // an almost straight arc, or enclosing it.
+  struct Case {
+    int xc, yc, r;
+  } cases[] = {{0, 0, 2000000000},
+               {0, -1999999950, 2000000000},
+               {0, 1999999950, 2000000000},
+               {-2000000000, 10, 2000000030},
+               {1000000000, 1000000000, 1414213562},
+               {INT_MIN, INT_MIN, INT_MAX},
+               {0, 0, INT_MAX},
+               {INT_MAX, 0, INT_MAX}};
+  Rect clip{-100, -100, 100, 100};
+  for (const Case &c : cases) {
+    PixelRecorder actual;
+    midPointCircle(actual, clip, c.xc, c.yc, c.r);
+    CircleOutline outline(c.xc, c.yc, c.r);
+    std::string what = "midPointCircle(" + std::to_string(c.xc) + ", " +
+                       std::to_string(c.yc) + ", " + std::to_string(c.r) + ")";
+    auto onOutline = [&](int x, int y) { return outline.contains(x, y); };
+    if (!report(actual.pixels() == pixelsWhere(clip, onOutline), what, clip)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fills --------------------------------------------------------------------
+
+// Filled circle rows span out to the row's farthest outline pixel.
+int64_t fillHalfWidth(const CircleOutline &outline, int64_t d) {
+  int64_t w = d <= outline.last ? outline.y(d) : -1;
+  int64_t u = search(0, outline.last,
+                     [&](int64_t x) { return outline.y(x) < d; }) -
+              1;
+  if (u >= 0 && outline.y(u) == d) {
+    w = std::max(w, u);
+  }
+  return w;
+}
+
+bool checkFills() {
+  std::mt19937 rng(22);
+  for (int i = 0; i < kRandomCases; ++i) {
+    Rect clip = randomClip(rng);
+    int xc = int(rng() % 401) - 200, yc = int(rng() % 401) - 200;
+    int rx = int(rng() % 300), ry = int(rng() % 300);
+    if (i % 8 == 0) {
+      ry = rng() % 2 == 0 ? 0 : rx;
+      rx = rng() % 2 == 0 ? 0 : rx;
+    }
+    PixelRecorder expected, actual;
+    ClipSink clipped(expected, clip);
+    fillCircle(clipped, xc, yc, rx);
+    fillCircle(actual, clip, xc, yc, rx);
+    std::string what = "fillCircle(" + std::to_string(xc) + ", " +
+                       std::to_string(yc) + ", " + std::to_string(rx) + ")";
+    if (!report(actual.pixels() == expected.pixels(), what, clip)) {
+      return false;
+    }
+    PixelRecorder expectedEllipse, actualEllipse;
+    ClipSink clippedEllipse(expectedEllipse, clip);
+    fillEllipse(clippedEllipse, xc, yc, rx, ry);
+    fillEllipse(actualEllipse, clip, xc, yc, rx, ry);
+    what = "fillEllipse(" + std::to_string(xc) + ", " + std::to_string(yc) +
+           ", " + std::to_string(rx) + ", " + std::to_string(ry) + ")";
+    if (!report(actualEllipse.pixels() == expectedEllipse.pixels(), what,
+                clip)) {
+      return false;
+    }
+  }
+
+  // Ellipses up to the radius limit still draw unclipped.
+  const int m = kMaxEllipseRadius;
+  struct Ellipse {
+    int xc, yc, rx, ry;
+  } ellipses[] = {{0, 0, m, m},           {0, -m + 50, m, m},
+                  {m - 30, 0, m, 100000}, {0, 0, 100000, 200000},
+                  {0, m, 1, m},           {-m, 0, m, 0}};
+  Rect clip{-100, -100, 100, 100};
+  for (const Ellipse &e : ellipses) {
+    PixelRecorder expected, actual;
+    ClipSink clipped(expected, clip);
+    fillEllipse(clipped, e.xc, e.yc, e.rx, e.ry);
+    fillEllipse(actual, clip, e.xc, e.yc, e.rx, e.ry);
+    std::string what = "fillEllipse(" + std::to_string(e.xc) + ", " +
+                       std::to_string(e.yc) + ", " + std::to_string(e.rx) +
+                       ", " + std::to_string(e.ry) + ")";
+    if (!report(actual.pixels() == expected.pixels(), what, clip)) {
+      return false;
+    }
+  }
+
+  // Circles too large to fill unclipped, against the outline reference.
+  struct Circle {
+    int xc, yc, r;
+  } circles[] = {{0, -1000000000, 1000000050},
+                 {0, 0, 2000000000},
+                 {1000000000, 1000000000, 1414213562},
+                 {INT_MIN, INT_MIN, INT_MAX},
+                 {INT_MAX, 0, INT_MAX}};
+  for (const Circle &c : circles) {
+    PixelRecorder actual;
+    fillCircle(actual, clip, c.xc, c.yc, c.r);
+    CircleOutline outline(c.xc, c.yc, c.r);
+    auto inFill = [&](int x, int y) {
+      int64_t u = std::abs(int64_t(x) - c.xc);
+      int64_t v = std::abs(int64_t(y) - c.yc);
+      return v <= c.r && u <= fillHalfWidth(outline, v);
+    };
+    std::string what = "fillCircle(" + std::to_string(c.xc) + ", " +
+                       std::to_string(c.yc) + ", " + std::to_string(c.r) + ")";
+    if (!report(actual.pixels() == pixelsWhere(clip, inFill), what, clip)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main() {
+  if (!checkLines() || !checkCircles() || !checkFills()) {
+    return 1;
+  }
+  std::cout << "clipped shapes match" << std::endl;
+  return 0;
+}
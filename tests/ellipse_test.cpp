@@ -0,0 +1,256 @@
+// midPointEllipse() and fillEllipse() against a reference midpoint walk that
+// evaluates every decision from scratch in 128-bit integers, for every pair
+// of radii up to kExhaustive and for large radii up to kMaxEllipseRadius,
+// past 32767 where 4 rx^2 ry^2 no longer fits int64. The clipped
+// midPointEllipse() is checked against the same outline cut to windows over
+// every part of it. Exits non-zero on the first mismatching ellipses.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../common/clip.h"
+#include "../common/raster.h"
+
+namespace {
+
+using int128 = __int128;
+
+const int kExhaustive = 200;
+const int kExhaustiveClipped = 40;
+const int kInt64Radius = 32767;
+const int kMaxRadius = kMaxEllipseRadius;
+
+// First-quadrant points of the midpoint walk from (0, ry) to (rx, 0). The
+// decisions are the midpoint's ellipse function scaled by 4: f(x + 1,
+// y - 1/2) in region 1 and f(x + 1/2, y - 1) in region 2.
+std::vector<std::pair<int64_t, int64_t>> referenceWalk(int rx, int ry) {
+  const int128 a2 = int128(rx) * rx, b2 = int128(ry) * ry;
+  int64_t x = 0, y = ry;
+  std::vector<std::pair<int64_t, int64_t>> points = {{x, y}};
+  while (b2 * x < a2 * y) {
+    int128 p = 4 * b2 * (x + 1) * (x + 1) + a2 * (2 * y - 1) * (2 * y - 1) -
+               4 * a2 * b2;
+    x++;
+    if (p >= 0) {
+      y--;
+    }
+    points.push_back({x, y});
+  }
+  while (y > 0) {
+    int128 p = b2 * (2 * x + 1) * (2 * x + 1) +
+               4 * a2 * (y - 1) * (y - 1) - 4 * a2 * b2;
+    y--;
+    if (p <= 0) {
+      x++;
+    }
+    points.push_back({x, y});
+  }
+  return points;
+}
+
+uint64_t key(int64_t x, int64_t y) {
+  return uint64_t(uint32_t(int32_t(y))) << 32 | uint32_t(int32_t(x));
+}
+
+void sortUnique(std::vector<uint64_t> &pixels) {
+  std::sort(pixels.begin(), pixels.end());
+  pixels.erase(std::unique(pixels.begin(), pixels.end()), pixels.end());
+}
+
+// Records every pixel, however it arrives.
+class PixelRecorder : public PixelSink {
+public:
+  std::vector<uint64_t> pixels;
+
+  void setColor(Color) override {}
+  void plot(int x, int y) override { pixels.push_back(key(x, y)); }
+};
+
+// Records the spans of a filled shape; fills only ever emit spans.
+class SpanRecorder : public PixelSink {
+public:
+  std::vector<std::tuple<int, int, int>> spans;
+  bool plotted = false;
+
+  void setColor(Color) override {}
+  void plot(int, int) override { plotted = true; }
+  void span(int x0, int x1, int y) override { spans.emplace_back(y, x0, x1); }
+  void vspan(int, int, int) override { plotted = true; }
+};
+
+bool checkOutline(int rx, int ry) {
+  std::vector<uint64_t> expected;
+  for (const auto &p : referenceWalk(rx, ry)) {
+    expected.push_back(key(p.first, p.second));
+    expected.push_back(key(-p.first, p.second));
+    expected.push_back(key(p.first, -p.second));
+    expected.push_back(key(-p.first, -p.second));
+  }
+  sortUnique(expected);
+
+  PixelRecorder recorder;
+  midPointEllipse(recorder, 0, 0, rx, ry);
+  sortUnique(recorder.pixels);
+  if (recorder.pixels != expected) {
+    std::cerr << "midPointEllipse(rx = " << rx << ", ry = " << ry
+              << ") differs from the reference" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool checkFill(int rx, int ry) {
+  // The widest outline pixel on each row, mirrored.
+  std::vector<int64_t> halfWidth(size_t(ry) + 1, -1);
+  for (const auto &p : referenceWalk(rx, ry)) {
+    int64_t &w = halfWidth[size_t(p.second)];
+    w = std::max(w, p.first);
+  }
+  std::vector<std::tuple<int, int, int>> expected;
+  for (int y = -ry; y <= ry; ++y) {
+    int w = int(halfWidth[size_t(std::abs(y))]);
+    expected.emplace_back(y, -w, w);
+  }
+
+  SpanRecorder recorder;
+  fillEllipse(recorder, 0, 0, rx, ry);
+  std::sort(recorder.spans.begin(), recorder.spans.end());
+  if (recorder.plotted || recorder.spans != expected) {
+    std::cerr << "fillEllipse(rx = " << rx << ", ry = " << ry
+              << ") differs from the reference" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Windows of a few sizes on a grid over the ellipse's bounding box and its
+// surroundings, so every quadrant and region is cut in every way, and one
+// around the center, which large ellipses enclose without touching.
+bool checkClipped(int rx, int ry) {
+  std::vector<uint64_t> outline;
+  for (const auto &p : referenceWalk(rx, ry)) {
+    outline.push_back(key(p.first, p.second));
+    outline.push_back(key(-p.first, p.second));
+    outline.push_back(key(p.first, -p.second));
+    outline.push_back(key(-p.first, -p.second));
+  }
+  sortUnique(outline);
+
+  auto checkWindow = [&](const Rect &clip) {
+    std::vector<uint64_t> expected;
+    for (uint64_t k : outline) {
+      if (clip.contains(int32_t(uint32_t(k)), int32_t(k >> 32))) {
+        expected.push_back(k);
+      }
+    }
+    PixelRecorder recorder;
+    midPointEllipse(recorder, clip, 0, 0, rx, ry);
+    sortUnique(recorder.pixels);
+    if (recorder.pixels != expected) {
+      std::cerr << "midPointEllipse(rx = " << rx << ", ry = " << ry
+                << ") clipped to (" << clip.xmin << ", " << clip.ymin
+                << ") - (" << clip.xmax << ", " << clip.ymax
+                << ") differs from the reference" << std::endl;
+      return false;
+    }
+    return true;
+  };
+  for (int size : {1, 7, std::max(rx, ry) / 2 + 1}) {
+    int stepX = std::max((2 * rx + size) / 7, 1);
+    int stepY = std::max((2 * ry + size) / 7, 1);
+    for (int x = -rx - size; x <= rx + 1; x += stepX) {
+      for (int y = -ry - size; y <= ry + 1; y += stepY) {
+        if (!checkWindow(Rect{x, y, x + size - 1, y + size - 1})) {
+          return false;
+        }
+      }
+    }
+  }
+  return checkWindow(Rect{-100, -100, 100, 100});
+}
+
+bool check(int rx, int ry) { return checkOutline(rx, ry) && checkFill(rx, ry); }
+
+// Radii past kMaxEllipseRadius draw nothing.
+bool checkRejected(int rx, int ry) {
+  PixelRecorder outline, clipped;
+  SpanRecorder fill;
+  midPointEllipse(outline, 0, 0, rx, ry);
+  midPointEllipse(clipped, Rect{-100, -100, 100, 100}, 0, 0, rx, ry);
+  fillEllipse(fill, 0, 0, rx, ry);
+  if (!outline.pixels.empty() || !clipped.pixels.empty() ||
+      !fill.spans.empty() || fill.plotted) {
+    std::cerr << "ellipse(rx = " << rx << ", ry = " << ry
+              << ") past the radius limit was drawn" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main() {
+  for (int rx = 0; rx <= kExhaustive; ++rx) {
+    for (int ry = 0; ry <= kExhaustive; ++ry) {
+      if (!check(rx, ry)) {
+        return 1;
+      }
+    }
+  }
+
+  for (int rx = 0; rx <= kExhaustiveClipped; ++rx) {
+    for (int ry = 0; ry <= kExhaustiveClipped; ++ry) {
+      if (!checkClipped(rx, ry)) {
+        return 1;
+      }
+    }
+  }
+
+  // The extremes of the int64 range, then a fixed random sample of large and
+  // very eccentric ellipses.
+  std::vector<std::pair<int, int>> large = {
+      {kInt64Radius, kInt64Radius}, {kInt64Radius, kInt64Radius - 1},
+      {kInt64Radius - 1, kInt64Radius}, {kInt64Radius, 1},
+      {1, kInt64Radius}, {kInt64Radius, 0},
+      {0, kInt64Radius}, {kInt64Radius, 2}};
+  large.insert(large.end(), {{kMaxRadius, kMaxRadius},
+                             {kMaxRadius, kMaxRadius - 1},
+                             {kMaxRadius - 1, kMaxRadius},
+                             {kMaxRadius, 1},
+                             {1, kMaxRadius},
+                             {kInt64Radius + 1, kInt64Radius + 1},
+                             {100000, 200000}});
+  for (const auto &radii : large) {
+    if (!checkClipped(radii.first, radii.second)) {
+      return 1;
+    }
+  }
+  std::mt19937 rng(14);
+  std::uniform_int_distribution<int> big(kExhaustive, kMaxRadius);
+  std::uniform_int_distribution<int> small(1, kExhaustive);
+  for (int i = 0; i < 8; ++i) {
+    large.push_back({big(rng), big(rng)});
+    large.push_back({big(rng), small(rng)});
+    large.push_back({small(rng), big(rng)});
+  }
+  for (const auto &radii : large) {
+    if (!check(radii.first, radii.second)) {
+      return 1;
+    }
+  }
+  for (int radius : {kMaxRadius + 1, INT_MAX, -1}) {
+    if (!checkRejected(radius, 1) || !checkRejected(1, radius) ||
+        !checkRejected(radius, radius)) {
+      return 1;
+    }
+  }
+  std::cout << "ellipses match the reference" << std::endl;
+  return 0;
+}
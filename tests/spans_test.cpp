@@ -0,0 +1,100 @@
+// bresenhamSpans() and DDA_lineSpans() against bresenham() and DDA_line(),
+// for every line from a few starting points to every end point of a square,
+// then a fixed random sample of long lines. The span versions must draw the
+// same pixels, each run well formed. Exits non-zero on the first mismatch.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../common/raster.h"
+
+namespace {
+
+const int kExhaustive = 48;
+const int kRandomLines = 2000;
+
+uint64_t key(int x, int y) {
+  return uint64_t(uint32_t(y)) << 32 | uint32_t(x);
+}
+
+// Records every pixel as a sorted set; runs given backwards are flagged.
+class PixelRecorder : public PixelSink {
+public:
+  bool backwards = false;
+
+  void setColor(Color) override {}
+  void plot(int x, int y) override { pixels_.push_back(key(x, y)); }
+  void span(int x0, int x1, int y) override {
+    backwards = backwards || x0 > x1;
+    PixelSink::span(x0, x1, y);
+  }
+  void vspan(int x, int y0, int y1) override {
+    backwards = backwards || y0 > y1;
+    PixelSink::vspan(x, y0, y1);
+  }
+
+  std::vector<uint64_t> pixels() {
+    std::sort(pixels_.begin(), pixels_.end());
+    pixels_.erase(std::unique(pixels_.begin(), pixels_.end()), pixels_.end());
+    return pixels_;
+  }
+
+private:
+  std::vector<uint64_t> pixels_;
+};
+
+using LineFunction = void (*)(PixelSink &, int, int, int, int);
+
+bool checkPair(const char *name, LineFunction plotted, LineFunction spans,
+               int x1, int y1, int x2, int y2) {
+  PixelRecorder expected, actual;
+  plotted(expected, x1, y1, x2, y2);
+  spans(actual, x1, y1, x2, y2);
+  if (actual.backwards || actual.pixels() != expected.pixels()) {
+    std::cerr << name << "(" << x1 << ", " << y1 << ", " << x2 << ", " << y2
+              << ") differs from the plotted line" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool check(int x1, int y1, int x2, int y2) {
+  return checkPair("bresenhamSpans", bresenham, bresenhamSpans, x1, y1, x2,
+                   y2) &&
+         checkPair("DDA_lineSpans", DDA_line, DDA_lineSpans, x1, y1, x2, y2);
+}
+
+} // namespace
+
+int main() {
+  const int starts[][2] = {{0, 0}, {3, -5}, {-1000, 777}};
+  for (const auto &start : starts) {
+    for (int dy = -kExhaustive; dy <= kExhaustive; ++dy) {
+      for (int dx = -kExhaustive; dx <= kExhaustive; ++dx) {
+        if (!check(start[0], start[1], start[0] + dx, start[1] + dy)) {
+          return 1;
+        }
+      }
+    }
+  }
+
+  std::mt19937 rng(4);
+  std::uniform_int_distribution<int> position(-1000000, 1000000);
+  std::uniform_int_distribution<int> length(-20000, 20000);
+  for (int i = 0; i < kRandomLines; ++i) {
+    int x1 = position(rng), y1 = position(rng);
+    int dx = length(rng), dy = length(rng);
+    if (i % 4 == 0) {
+      dy = i % 8 == 0 ? 0 : dx; // horizontal and diagonal runs
+    }
+    if (!check(x1, y1, x1 + dx, y1 + dy)) {
+      return 1;
+    }
+  }
+  std::cout << "span lines match the plotted ones" << std::endl;
+  return 0;
+}
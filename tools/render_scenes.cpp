@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/framebuffer.h"
+#include "../common/geometry_file.h"
+#include "../common/scene_file.h"
+#include "../common/thread_pool.h"
+
+// Batch renderer: draws scene files (format in common/scene_file.h) without a
+// window and saves each as an image. Scenes are rendered in parallel, one task
+// per scene, all in one process.
+//
+//   cg_render [-j THREADS] [-o DIR] [-e png|ppm|cgb] SCENE...
+//
+// A SCENE of "-" reads further scene paths from standard input, one per line,
+// so the renderer can sit at the end of a pipeline. Each image is written to
+// the scene's "output" path, or else to DIR/<scene name>.<ext>.
+//
+// SCENEs ending in .cgb are binary geometry files (common/geometry_file.h),
+// drawn straight from a memory map. "-e cgb" converts scenes to that format
+// instead of rendering them.
+
+namespace {
+
+void usage() {
+  std::cerr
+      << "usage: cg_render [-j THREADS] [-o DIR] [-e png|ppm|cgb] SCENE..."
+      << std::endl;
+}
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string defaultOutput(const std::string &dir, const std::string &path,
+                          const std::string &extension) {
+  size_t slash = path.find_last_of('/');
+  std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+  size_t dot = name.find_last_of('.');
+  if (dot != std::string::npos && dot > 0) {
+    name.resize(dot);
+  }
+  return dir + "/" + name + "." + extension;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+  std::string outputDir = ".", extension = "png";
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-j" || arg == "-o" || arg == "-e") && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (arg == "-j") {
+        threads = unsigned(std::max(atoi(value.c_str()), 1));
+      } else if (arg == "-o") {
+        outputDir = value;
+      } else if (value == "png" || value == "ppm" || value == "cgb") {
+        extension = value;
+      } else {
+        usage();
+        return 2;
+      }
+    } else if (arg == "-") {
+      for (std::string line; std::getline(std::cin, line);) {
+        if (!line.empty()) {
+          paths.push_back(line);
+        }
+      }
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      usage();
+      return 2;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  if (paths.empty()) {
+    usage();
+    return 2;
+  }
+
+  ThreadPool pool(threads);
+  std::atomic<size_t> failed{0};
+  auto start = std::chrono::steady_clock::now();
+  pool.parallelFor(paths.size(), [&](size_t i) {
+    SceneFile scene;
+    GeometryFile mapped;
+    GeometryData data;
+    if (endsWith(paths[i], ".cgb")) {
+      if (!mapped.open(paths[i])) {
+        ++failed;
+        return;
+      }
+      data = mapped.data();
+    } else {
+      if (!loadScene(paths[i], scene)) {
+        ++failed;
+        return;
+      }
+      data.scene = scene.view();
+    }
+    if (extension == "cgb") {
+      // Rewriting a file in place would truncate the mapping being read.
+      std::string output = defaultOutput(outputDir, paths[i], extension);
+      std::error_code error;
+      if (std::filesystem::equivalent(output, paths[i], error)) {
+        std::cerr << paths[i] << ": would overwrite itself" << std::endl;
+        ++failed;
+      } else if (!writeGeometryFile(output, data)) {
+        ++failed;
+      }
+      return;
+    }
+    Framebuffer framebuffer(data.scene.width, data.scene.height);
+    renderGeometry(data, framebuffer);
+    std::string output = scene.output.empty()
+                             ? defaultOutput(outputDir, paths[i], extension)
+                             : scene.output;
+    if (!framebuffer.save(output)) {
+      ++failed;
+    }
+  });
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  size_t rendered = paths.size() - failed;
+  std::cout << (extension == "cgb" ? "Converted " : "Rendered ") << rendered
+            << " of " << paths.size()
+            << " scenes in " << seconds << " s ("
+            << (seconds > 0 ? rendered / seconds : 0) << " scenes/s, "
+            << pool.size() << " threads)" << std::endl;
+  return failed == 0 ? 0 : 1;
+}